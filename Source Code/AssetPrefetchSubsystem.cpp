@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AssetPrefetchSubsystem.h"
+#include "MyProject.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Prefetch Asset Loaded"), STAT_PrefetchAssetLoaded, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prefetch Hits"), STAT_PrefetchHits, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prefetch Misses"), STAT_PrefetchMisses, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prefetch Evictions"), STAT_PrefetchEvictions, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prefetch Loads In Flight"), STAT_PrefetchInFlight, STATGROUP_MyProject);
+DECLARE_MEMORY_STAT(TEXT("Prefetch Resident"), STAT_PrefetchResident, STATGROUP_MyProject);
+
+static void PrefetchStatsCommand(const TArray<FString>& Args, UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	UAssetPrefetchSubsystem* Prefetcher = GameInstance ? GameInstance->GetSubsystem<UAssetPrefetchSubsystem>() : nullptr;
+	if (Prefetcher == nullptr) return;
+
+	const int32 Uses = Prefetcher->GetNumHits() + Prefetcher->GetNumMisses();
+	UE_LOG(LogTemp, Log, TEXT("Prefetch: %d hits, %d misses (%.0f%% hit rate), %d assets, %.1f of %d MB"),
+		Prefetcher->GetNumHits(), Prefetcher->GetNumMisses(), Uses > 0 ? 100.f * Prefetcher->GetNumHits() / Uses : 0.f,
+		Prefetcher->GetNumAssets(), Prefetcher->GetResidentBytes() / (1024.f * 1024.f), Prefetcher->MemoryBudgetMB);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs PrefetchStatsConsoleCommand(
+	TEXT("MyProject.PrefetchStats"),
+	TEXT("Logs asset prefetch hits, misses and memory use. Usage: MyProject.PrefetchStats"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrefetchStatsCommand));
+
+UAssetPrefetchSubsystem::UAssetPrefetchSubsystem()
+{
+	MemoryBudgetMB = 256;
+
+	LoadedManifest = nullptr;
+	UseClock = 0;
+	ResidentBytes = 0;
+	NumHits = 0;
+	NumMisses = 0;
+}
+
+void UAssetPrefetchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Only names and soft references, same as the weapon catalog
+	if (!Manifest.IsNull())
+	{
+		LoadedManifest = Manifest.LoadSynchronous();
+	}
+}
+
+void UAssetPrefetchSubsystem::Deinitialize()
+{
+	for (TPair<FSoftObjectPath, FPrefetchEntry>& Entry : Entries)
+	{
+		if (Entry.Value.Handle.IsValid())
+		{
+			Entry.Value.Handle->CancelHandle();
+		}
+	}
+	Entries.Empty();
+	UsedAssets.Empty();
+
+	ResidentBytes = 0;
+	SET_MEMORY_STAT(STAT_PrefetchResident, 0);
+
+	Super::Deinitialize();
+}
+
+void UAssetPrefetchSubsystem::Prefetch(const TArray<FSoftObjectPath>& Assets, int32 Priority, FSimpleDelegate OnLoaded)
+{
+	// The batch starts with one count for this function, so nothing that finishes while we're still issuing requests can call OnLoaded early
+	TSharedPtr<FPrefetchBatch> Batch = MakeShared<FPrefetchBatch>();
+	Batch->Remaining = 1;
+	Batch->OnLoaded = OnLoaded;
+
+	FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+
+	// Assets used without ever being prefetched are never evicted, so they're only forgotten once GC has freed them.
+	// This is called once per level, which is often enough to keep that from building up
+	for (auto It = UsedAssets.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const FSoftObjectPath& Path : Assets)
+	{
+		if (Path.IsNull()) continue;
+
+		FPrefetchEntry& Entry = Entries.FindOrAdd(Path);
+		Entry.Priority = FMath::Max(Entry.Priority, Priority);
+		Entry.LastUsed = ++UseClock;
+
+		if (Entry.bLoaded) continue;
+
+		if (!Entry.Handle.IsValid())
+		{
+			INC_DWORD_STAT(STAT_PrefetchInFlight);
+		}
+
+		// The streamable manager merges requests for the same asset, so asking again while it's loading just adds our callback
+		Batch->Remaining++;
+		TSharedPtr<FStreamableHandle> Handle = Streamable.RequestAsyncLoad(Path,
+			FStreamableDelegate::CreateUObject(this, &UAssetPrefetchSubsystem::OnAssetLoaded, Path, Batch), Priority);
+
+		// Something already in memory can complete inside RequestAsyncLoad, so look the entry up again rather than trusting Entry
+		FPrefetchEntry* Requested = Entries.Find(Path);
+		if (!Handle.IsValid())
+		{
+			// Nothing the streamable manager could load, don't keep the batch waiting on it
+			if (Requested && !Requested->bLoaded)
+			{
+				DEC_DWORD_STAT(STAT_PrefetchInFlight);
+				Entries.Remove(Path);
+			}
+			Batch->Remaining--;
+			continue;
+		}
+
+		if (Requested && !Requested->Handle.IsValid())
+		{
+			Requested->Handle = Handle;
+		}
+	}
+
+	if (--Batch->Remaining == 0)
+	{
+		Batch->OnLoaded.ExecuteIfBound();
+	}
+}
+
+void UAssetPrefetchSubsystem::PrefetchLevel(FName LevelName, FSimpleDelegate OnLoaded)
+{
+	const FPrefetchAssetList* List = LoadedManifest ? LoadedManifest->Levels.Find(LevelName) : nullptr;
+	if (List == nullptr)
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	TArray<FSoftObjectPath> Paths;
+	Paths.Reserve(List->Assets.Num());
+	for (const TSoftObjectPtr<UObject>& Asset : List->Assets)
+	{
+		Paths.Add(Asset.ToSoftObjectPath());
+	}
+
+	Prefetch(Paths, List->Priority, OnLoaded);
+}
+
+void UAssetPrefetchSubsystem::OnAssetLoaded(FSoftObjectPath Path, TSharedPtr<FPrefetchBatch> Batch)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PrefetchAssetLoaded);
+
+	FPrefetchEntry* Entry = Entries.Find(Path);
+	if (Entry && !Entry->bLoaded)
+	{
+		DEC_DWORD_STAT(STAT_PrefetchInFlight);
+
+		UObject* Asset = Path.ResolveObject();
+		if (Asset)
+		{
+			Entry->bLoaded = true;
+			Entry->SizeBytes = EstimateSize(Asset);
+			ResidentBytes += Entry->SizeBytes;
+			SET_MEMORY_STAT(STAT_PrefetchResident, ResidentBytes);
+
+			EnforceBudget();
+		}
+		else
+		{
+			// Bad path or a failed load. Drop it so a later request can try again
+			Entries.Remove(Path);
+		}
+	}
+
+	if (--Batch->Remaining == 0)
+	{
+		Batch->OnLoaded.ExecuteIfBound();
+	}
+}
+
+void UAssetPrefetchSubsystem::NoteUse(const UObject* Asset)
+{
+	if (Asset == nullptr) return;
+
+	// Already counted, all that's left is keeping it from being evicted
+	if (const FSoftObjectPath* UsedPath = UsedAssets.Find(Asset))
+	{
+		if (FPrefetchEntry* Entry = Entries.Find(*UsedPath))
+		{
+			Entry->LastUsed = ++UseClock;
+		}
+		return;
+	}
+
+	const FSoftObjectPath Path(Asset);
+	UsedAssets.Add(Asset, Path);
+
+	// Not prefetched at all, or still loading, both count against us. The prefetch didn't start early enough
+	FPrefetchEntry* Entry = Entries.Find(Path);
+	if (Entry)
+	{
+		Entry->LastUsed = ++UseClock;
+	}
+	if (Entry && Entry->bLoaded)
+	{
+		NumHits++;
+		INC_DWORD_STAT(STAT_PrefetchHits);
+	}
+	else
+	{
+		NumMisses++;
+		INC_DWORD_STAT(STAT_PrefetchMisses);
+	}
+}
+
+void UAssetPrefetchSubsystem::EnforceBudget()
+{
+	const int64 BudgetBytes = int64(MemoryBudgetMB) * 1024 * 1024;
+
+	// A straight scan for the victim. We hold tens of assets, not thousands, so it isn't worth keeping a list in order
+	while (ResidentBytes > BudgetBytes)
+	{
+		const FSoftObjectPath* Victim = nullptr;
+		const FPrefetchEntry* VictimEntry = nullptr;
+		for (const TPair<FSoftObjectPath, FPrefetchEntry>& Entry : Entries)
+		{
+			if (!Entry.Value.bLoaded) continue;
+
+			if (VictimEntry == nullptr || Entry.Value.Priority < VictimEntry->Priority
+				|| (Entry.Value.Priority == VictimEntry->Priority && Entry.Value.LastUsed < VictimEntry->LastUsed))
+			{
+				Victim = &Entry.Key;
+				VictimEntry = &Entry.Value;
+			}
+		}
+
+		if (Victim == nullptr) break;
+
+		// Letting go of the handle is all it takes, GC frees the asset once nothing else is using it
+		ResidentBytes -= VictimEntry->SizeBytes;
+		if (VictimEntry->Handle.IsValid())
+		{
+			VictimEntry->Handle->ReleaseHandle();
+		}
+		// The asset is still loaded until GC gets to it, so it can be found to forget it was used. If it's prefetched and used again that's a new first use
+		UsedAssets.Remove(Victim->ResolveObject());
+		Entries.Remove(FSoftObjectPath(*Victim));
+
+		INC_DWORD_STAT(STAT_PrefetchEvictions);
+	}
+
+	SET_MEMORY_STAT(STAT_PrefetchResident, ResidentBytes);
+}
+
+int64 UAssetPrefetchSubsystem::EstimateSize(UObject* Asset)
+{
+	if (const UClass* Class = Cast<UClass>(Asset))
+	{
+		Asset = Class->GetDefaultObject();
+	}
+
+	// Only the asset itself, not everything it references. Good enough to keep the cache in check, not an exact figure
+	return Asset ? Asset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+}
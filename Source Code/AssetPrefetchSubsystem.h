@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "AssetPrefetchSubsystem.generated.h"
+
+USTRUCT(BlueprintType)
+struct FPrefetchAssetList
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prefetch")
+	TArray<TSoftObjectPtr<UObject>> Assets;
+
+	/** Higher loads first and is evicted last */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prefetch")
+	int32 Priority = 0;
+};
+
+/**
+ * What each level needs warm before the player gets there, e.g. its enemy Blueprints, music and big meshes
+ * Keyed by the level's short name, the same name a transition volume's TransitionLevelName uses
+ */
+UCLASS(BlueprintType)
+class MYPROJECT_API UPrefetchManifest : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prefetch")
+	TMap<FName, FPrefetchAssetList> Levels;
+};
+
+/**
+ * Loads assets in the background before anything needs them, and keeps them loaded until memory runs short
+ *
+ * Transition volumes, spawn volumes and floor switches ask for what's on the other side of them as the player gets close.
+ * Every asset we hold counts towards MemoryBudgetMB; once we're over, the lowest priority asset that was used longest ago goes first.
+ * Code that actually uses an asset tells us with NoteUse, and its first use counts as a hit if we had it ready and a miss if we
+ * didn't, which is what the Prefetch Hits and Prefetch Misses stats show.
+ * Lives on the game instance so whatever was loaded for the next level is still there after the travel.
+ */
+UCLASS(Config = Game)
+class MYPROJECT_API UAssetPrefetchSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UAssetPrefetchSubsystem();
+
+	/** Per level asset lists. Set in DefaultGame.ini under [/Script/MyProject.AssetPrefetchSubsystem] */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UPrefetchManifest> Manifest;
+
+	/** Roughly how much we'll keep loaded. It's an estimate from each asset's own resource size, see EstimateSize */
+	UPROPERTY(Config)
+	int32 MemoryBudgetMB;
+
+	// USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Starts loading anything in Assets we don't already have. OnLoaded fires once all of them are in, straight away if they already are */
+	void Prefetch(const TArray<FSoftObjectPath>& Assets, int32 Priority, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	/** Prefetches the manifest's list for a level. Does nothing for levels the manifest doesn't know */
+	void PrefetchLevel(FName LevelName, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	/** Call when an asset is actually used. Keeps it from being evicted and counts its first use as a hit or a miss */
+	void NoteUse(const UObject* Asset);
+
+	FORCEINLINE int64 GetResidentBytes() const { return ResidentBytes; }
+	FORCEINLINE int32 GetNumHits() const { return NumHits; }
+	FORCEINLINE int32 GetNumMisses() const { return NumMisses; }
+	FORCEINLINE int32 GetNumAssets() const { return Entries.Num(); }
+
+private:
+	struct FPrefetchEntry
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		int64 SizeBytes = 0;
+		int32 Priority = 0;
+
+		/** UseClock when this was last asked for or used. Lowest goes first */
+		uint64 LastUsed = 0;
+
+		bool bLoaded = false;
+	};
+
+	/** One call to Prefetch, so its OnLoaded can wait for every asset in it */
+	struct FPrefetchBatch
+	{
+		int32 Remaining = 0;
+		FSimpleDelegate OnLoaded;
+	};
+
+	void OnAssetLoaded(FSoftObjectPath Path, TSharedPtr<FPrefetchBatch> Batch);
+
+	/** Evicts until we're back under budget */
+	void EnforceBudget();
+
+	/** What an asset costs us. For a class that's its defaults, since the class object itself is tiny */
+	static int64 EstimateSize(UObject* Asset);
+
+	TMap<FSoftObjectPath, FPrefetchEntry> Entries;
+
+	/**
+	 * Every asset whose first use has been counted, with its path. NoteUse is called for every hit effect, so after the first time
+	 * it finds the entry through here rather than building the asset's path again. Evicting an entry removes its asset from here too
+	 */
+	TMap<TWeakObjectPtr<const UObject>, FSoftObjectPath> UsedAssets;
+
+	UPROPERTY(Transient)
+	UPrefetchManifest* LoadedManifest;
+
+	uint64 UseClock;
+	int64 ResidentBytes;
+	int32 NumHits;
+	int32 NumMisses;
+};
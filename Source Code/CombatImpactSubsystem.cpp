@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatImpactSubsystem.h"
+#include "MyProject.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+#include "Sound/SoundCue.h"
+#include "Sound/SoundNodeWavePlayer.h"
+#include "Sound/SoundWave.h"
+#include "AudioDevice.h"
+#include "Engine/GameInstance.h"
+#include "AssetPrefetchSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat Impacts Flush"), STAT_CombatImpactsFlush, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Impacts Played"), STAT_CombatImpactsPlayed, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Impacts Coalesced"), STAT_CombatImpactsCoalesced, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Impacts Over Budget"), STAT_CombatImpactsOverBudget, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Impacts Warmed"), STAT_CombatImpactsWarmed, STATGROUP_MyProject);
+
+UCombatImpactSubsystem::UCombatImpactSubsystem()
+{
+	MaxConcurrentParticles = 16;
+	MaxConcurrentSounds = 8;
+	CoalesceDistance = 25.f;
+}
+
+TStatId UCombatImpactSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_CombatImpactsFlush);
+}
+
+void UCombatImpactSubsystem::PlayImpact(UParticleSystem* Particles, USoundBase* Sound, const FVector& Location)
+{
+	if (Particles == nullptr && Sound == nullptr) return;
+
+	// Already got the same impact queued right here this frame? Then this one's a duplicate
+	const float CoalesceDistanceSquared = FMath::Square(CoalesceDistance);
+	for (const FPendingImpact& Pending : PendingImpacts)
+	{
+		if (Pending.Particles == Particles && Pending.Sound == Sound && FVector::DistSquared(Pending.Location, Location) <= CoalesceDistanceSquared)
+		{
+			INC_DWORD_STAT(STAT_CombatImpactsCoalesced);
+			return;
+		}
+	}
+
+	PendingImpacts.Add({ Particles, Sound, Location });
+}
+
+void UCombatImpactSubsystem::Tick(float DeltaTime)
+{
+	if (PendingImpacts.Num() == 0) return;
+
+	// So the prefetcher knows whether it got these ready in time
+	UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	UAssetPrefetchSubsystem* Prefetcher = GameInstance ? GameInstance->GetSubsystem<UAssetPrefetchSubsystem>() : nullptr;
+
+	for (const FPendingImpact& Impact : PendingImpacts)
+	{
+		if (Prefetcher)
+		{
+			Prefetcher->NoteUse(Impact.Particles);
+			Prefetcher->NoteUse(Impact.Sound);
+		}
+		if (Impact.Particles)
+		{
+			PlayParticles(Impact.Particles, Impact.Location);
+		}
+		if (Impact.Sound)
+		{
+			PlaySound(Impact.Sound);
+		}
+	}
+
+	PendingImpacts.Reset();
+}
+
+void UCombatImpactSubsystem::PlayParticles(UParticleSystem* Particles, const FVector& Location)
+{
+	// Reuse a component that's finished playing if we've got one
+	UParticleSystemComponent* Component = nullptr;
+	for (UParticleSystemComponent* Existing : ParticleComponents)
+	{
+		if (Existing && !Existing->IsActive())
+		{
+			Component = Existing;
+			break;
+		}
+	}
+
+	if (Component == nullptr)
+	{
+		if (ParticleComponents.Num() >= MaxConcurrentParticles)
+		{
+			// Enough blood on screen already, nobody will miss this one
+			INC_DWORD_STAT(STAT_CombatImpactsOverBudget);
+			return;
+		}
+
+		// bAutoDestroy is off so the component sticks around for us to reuse
+		Component = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Particles, Location, FRotator(0.f), false, EPSCPoolMethod::None, false);
+		if (Component == nullptr) return;
+
+		ParticleComponents.Add(Component);
+	}
+
+	Component->SetTemplate(Particles);
+	Component->SetWorldLocationAndRotation(Location, FRotator(0.f));
+	Component->ActivateSystem(true);
+
+	INC_DWORD_STAT(STAT_CombatImpactsPlayed);
+}
+
+void UCombatImpactSubsystem::PlaySound(USoundBase* Sound)
+{
+	UAudioComponent* Component = nullptr;
+	for (UAudioComponent* Existing : AudioComponents)
+	{
+		if (Existing && !Existing->IsPlaying())
+		{
+			Component = Existing;
+			break;
+		}
+	}
+
+	if (Component == nullptr)
+	{
+		if (AudioComponents.Num() >= MaxConcurrentSounds)
+		{
+			INC_DWORD_STAT(STAT_CombatImpactsOverBudget);
+			return;
+		}
+
+		// Hit sounds have always been 2D (PlaySound2D), this keeps them that way but lets us hold on to the component
+		Component = UGameplayStatics::CreateSound2D(GetWorld(), Sound, 1.f, 1.f, 0.f, nullptr, false, false);
+		if (Component == nullptr) return;
+
+		AudioComponents.Add(Component);
+	}
+
+	Component->SetSound(Sound);
+	Component->Play();
+}
+
+void UCombatImpactSubsystem::WarmImpact(UParticleSystem* Particles, USoundBase* Sound)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return;
+
+	// A component that already has this template is as warm as it gets, it's what the first hit will reuse
+	bool bParticlesWarm = Particles == nullptr;
+	for (UParticleSystemComponent* Existing : ParticleComponents)
+	{
+		if (Existing && Existing->Template == Particles)
+		{
+			bParticlesWarm = true;
+			break;
+		}
+	}
+
+	if (!bParticlesWarm && ParticleComponents.Num() < MaxConcurrentParticles)
+	{
+		UParticleSystemComponent* Component = UGameplayStatics::SpawnEmitterAtLocation(World, Particles, FVector::ZeroVector, FRotator(0.f), false, EPSCPoolMethod::None, false);
+		if (Component)
+		{
+			ParticleComponents.Add(Component);
+			INC_DWORD_STAT(STAT_CombatImpactsWarmed);
+		}
+	}
+
+	if (Sound == nullptr) return;
+
+	bool bSoundWarm = false;
+	for (UAudioComponent* Existing : AudioComponents)
+	{
+		if (Existing && Existing->Sound == Sound)
+		{
+			bSoundWarm = true;
+			break;
+		}
+	}
+
+	if (bSoundWarm) return;
+
+	if (AudioComponents.Num() < MaxConcurrentSounds)
+	{
+		UAudioComponent* Component = UGameplayStatics::CreateSound2D(World, Sound, 1.f, 1.f, 0.f, nullptr, false, false);
+		if (Component)
+		{
+			AudioComponents.Add(Component);
+		}
+	}
+
+	// Decompress the waves now rather than on the first play
+	FAudioDevice* AudioDevice = World->GetAudioDeviceRaw();
+	if (AudioDevice == nullptr) return;
+
+	TArray<USoundWave*> Waves;
+	if (USoundWave* Wave = Cast<USoundWave>(Sound))
+	{
+		Waves.Add(Wave);
+	}
+	else if (USoundCue* Cue = Cast<USoundCue>(Sound))
+	{
+		TArray<USoundNodeWavePlayer*> WavePlayers;
+		Cue->RecursiveFindNode<USoundNodeWavePlayer>(Cue->FirstNode, WavePlayers);
+		for (USoundNodeWavePlayer* WavePlayer : WavePlayers)
+		{
+			if (WavePlayer && WavePlayer->GetSoundWave())
+			{
+				Waves.AddUnique(WavePlayer->GetSoundWave());
+			}
+		}
+	}
+
+	for (USoundWave* Wave : Waves)
+	{
+		AudioDevice->Precache(Wave);
+	}
+
+	INC_DWORD_STAT(STAT_CombatImpactsWarmed);
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatImpactSubsystem.generated.h"
+
+/**
+ * Plays hit particles and hit sounds for combat impacts out of a small pool of reusable components
+ * Impacts are queued during the frame and played together at the end of it, so the same effect landing in the same spot
+ * more than once in a frame (several enemies hit by one swing, overlaps with two of our components) only plays once
+ */
+UCLASS(Config = Game)
+class MYPROJECT_API UCombatImpactSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UCombatImpactSubsystem();
+
+	/** Most particle effects we'll have playing at once. Impacts past this are dropped */
+	UPROPERTY(Config)
+	int32 MaxConcurrentParticles;
+
+	/** Most hit sounds we'll have playing at once */
+	UPROPERTY(Config)
+	int32 MaxConcurrentSounds;
+
+	/** Impacts with the same effects closer together than this in the same frame are treated as one */
+	UPROPERTY(Config)
+	float CoalesceDistance;
+
+	/** Queues an impact for this frame. Either effect can be null */
+	void PlayImpact(class UParticleSystem* Particles, class USoundBase* Sound, const FVector& Location);
+
+	/**
+	 * Gets an impact ready before its first hit: a pooled component already set up with the particle system and one with the sound,
+	 * and the sound's waves decompressed. Spawn volumes call this for their enemies as the player gets near
+	 */
+	void WarmImpact(UParticleSystem* Particles, USoundBase* Sound);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !IsTemplate(); }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	struct FPendingImpact
+	{
+		UParticleSystem* Particles;
+		USoundBase* Sound;
+		FVector Location;
+	};
+
+	TArray<FPendingImpact> PendingImpacts;
+
+	void PlayParticles(UParticleSystem* Particles, const FVector& Location);
+	void PlaySound(USoundBase* Sound);
+
+	// Every component we've created, playing or not. A component that has finished is free to be reused
+	UPROPERTY()
+	TArray<class UParticleSystemComponent*> ParticleComponents;
+
+	UPROPERTY()
+	TArray<class UAudioComponent*> AudioComponents;
+};
@@ -13,15 +13,26 @@
 #include "Engine/SkeletalMeshSocket.h"
 #include "Sound/SoundCue.h"
 #include "Animation/AnimInstance.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
+#include "EnemyPoolSubsystem.h"
 #include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "MainPlayerController.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "EnemySpatialSubsystem.h"
+#include "EnemyDirectorSubsystem.h"
+#include "EnemyFlowFieldSubsystem.h"
+#include "CombatImpactSubsystem.h"
+#include "WorldStateSubsystem.h"
+#include "Engine/GameInstance.h"
 
 // Sets default values
-AEnemy::AEnemy()
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
+	// Nothing happens in our Tick, and the per frame work we do have (attack timing) is batched by UEnemyDirectorSubsystem
 
 	AggroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AggroSphere"));
 	AggroSphere->SetupAttachment(GetRootComponent()); // All character classes have a capsule component as their root, you cannot make another component equal to the root
@@ -35,6 +46,14 @@ AEnemy::AEnemy()
 	CombatSphere->InitSphereRadius(85.f);
 	// We'll need an OverlapBegin and End function for these so we can know when a player enters and leaves the sphere
 
+	// The animation budget allocator decides how often our mesh animates. The enemy director hands it our significance
+	// along with the AI LOD, so it doesn't need to work out distances again
+	USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh());
+	if (BudgetedMesh)
+	{
+		BudgetedMesh->SetAutoCalculateSignificance(false);
+	}
+
 	CombatCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("CombatCollision"));
 	// Instead of attaching this to the root component, we're gonna want to attach it to a specific location on the mesh itself
 	// namely its claws, so we put a socket on that part of the body
@@ -60,6 +79,20 @@ AEnemy::AEnemy()
 	DeathDelay = 3.f; // 3 seconds
 
 	bHasValidTarget = false;
+
+	Director = nullptr;
+	DirectorIndex = INDEX_NONE;
+
+	TipSocket = nullptr;
+
+	bUseFlowField = true;
+	ChaseTarget = nullptr;
+	bFollowingNavPath = false;
+
+	bPooled = false;
+	DefaultCapsuleCollision = ECollisionEnabled::QueryAndPhysics;
+	DefaultAggroSphereCollision = ECollisionEnabled::QueryAndPhysics;
+	DefaultCombatSphereCollision = ECollisionEnabled::QueryAndPhysics;
 }
 
 // Called when the game starts or when spawned
@@ -71,6 +104,8 @@ void AEnemy::BeginPlay()
 	// Right on BeginPlay we cast GetController which returns an AController and cast it to an AIController and store it in AIController so we have a reference to our...
 	// ... AIController
 
+	TipSocket = GetMesh()->GetSocketByName("TipSocket");
+
 	// Without below, when we enter the Aggro or Combat Sphere's, nothing will actually happen
 	// Need to bind an Overlap Event to our Overlap Components
 	AggroSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::AggroSphereOnOverlapBegin);
@@ -91,9 +126,55 @@ void AEnemy::BeginPlay()
 
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore); // Collision with the camera won't happen
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore); // Same thing as above
+
+	// Remember how our collision was set up, Die() turns it all off and the pool needs to turn it back on again
+	DefaultCapsuleCollision = GetCapsuleComponent()->GetCollisionEnabled();
+	DefaultAggroSphereCollision = AggroSphere->GetCollisionEnabled();
+	DefaultCombatSphereCollision = CombatSphere->GetCollisionEnabled();
+
+	RegisterWithSubsystems();
 	
 }
 
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromSubsystems();
+	Director = nullptr;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemy::RegisterWithSubsystems()
+{
+	// Let the spatial index know about us so the player can find us as a combat target without an overlap query
+	UEnemySpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UEnemySpatialSubsystem>();
+	if (SpatialSubsystem)
+	{
+		SpatialSubsystem->RegisterEnemy(this);
+	}
+
+	// Hand ourselves over to the director, which runs the batched update for every enemy
+	Director = GetWorld()->GetSubsystem<UEnemyDirectorSubsystem>();
+	if (Director)
+	{
+		Director->RegisterEnemy(this);
+	}
+}
+
+void AEnemy::UnregisterFromSubsystems()
+{
+	UEnemySpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UEnemySpatialSubsystem>();
+	if (SpatialSubsystem)
+	{
+		SpatialSubsystem->UnregisterEnemy(this);
+	}
+
+	if (Director)
+	{
+		Director->UnregisterEnemy(this);
+	}
+}
+
 // Called every frame
 void AEnemy::Tick(float DeltaTime)
 {
@@ -108,6 +189,15 @@ void AEnemy::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 
 }
 
+void AEnemy::SetEnemyMovementStatus(EEnemyMovementStatus Status)
+{
+	EnemyMovementStatus = Status;
+	if (Director)
+	{
+		Director->SetMovementStatus(this, Status);
+	}
+}
+
 void AEnemy::AggroSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
 {
 	// When the player enters this sphere, the enemy will move to the player
@@ -152,6 +242,7 @@ void AEnemy::AggroSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, A
 			if (AIController)
 			{
 				AIController->StopMovement(); // Will stop the movement if we leave the Aggro sphere
+				bFollowingNavPath = false;
 			}
 		}
 	}
@@ -177,7 +268,11 @@ void AEnemy::CombatSphereOnOverlapBegin(UPrimitiveComponent* OverlappedComponent
 				bOverlappingCombatSphere = true;
 				// Attack(); // Instead of calling attack we're going to put the AttackEnd timer here to ensure the player doesn't get spammed by enemy attacks
 				float AttackTime = FMath::FRandRange(AttackMinTime, AttackMaxTime);
-				GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime);
+				if (Director)
+				{
+					Director->SetTarget(this, Main);
+					Director->ScheduleAttack(this, AttackTime);
+				}
 			}
 		}
 	}
@@ -193,6 +288,10 @@ void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent,
 			bOverlappingCombatSphere = false;
 			MoveToTarget(Main);
 			CombatTarget = nullptr;
+			if (Director)
+			{
+				Director->SetTarget(this, nullptr);
+			}
 
 			if (Main->CombatTarget == this)
 			{
@@ -209,8 +308,11 @@ void AEnemy::CombatSphereOnOverlapEnd(UPrimitiveComponent* OverlappedComponent,
 				if(MainMesh) Main->MainPlayerController->RemoveEnemyHealthBar();
 			}
 		
-			GetWorldTimerManager().ClearTimer(AttackTimer); // When the PC leaves the combat sphere, this will reset the timer to ensure it doesn't resume where it left off
-			// Or keep counting
+			if (Director)
+			{
+				Director->CancelAttack(this); // When the PC leaves the combat sphere, this will reset the timer to ensure it doesn't resume where it left off
+				// Or keep counting
+			}
 		}
 	}
 }
@@ -220,9 +322,25 @@ void AEnemy::MoveToTarget(class AMain* Target)
 	// When we call this, we want to set our MovementStatus to "MoveToTarget"
 	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_MoveToTarget);
 
+	ChaseTarget = Target;
+
+	// With the flow field on, the enemy director steers us every update instead, so there's no path to request here
+	UEnemyFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UEnemyFlowFieldSubsystem>();
+	if (bUseFlowField && FlowField)
+	{
+		return;
+	}
+
+	RequestNavPath(Target);
+}
+
+void AEnemy::RequestNavPath(AMain* Target)
+{
 	// Now we actually need to move to the target
 	if (AIController)
 	{
+		bFollowingNavPath = true;
+
 		// If it's valid and we have a reference to our controller, we can actually give it some functionality
 		FAIMoveRequest MoveRequest; // A struct that we can set specific properties to get the AI to actually move
 		MoveRequest.SetGoalActor(Target);
@@ -258,6 +376,32 @@ void AEnemy::MoveToTarget(class AMain* Target)
 	}
 }
 
+void AEnemy::SteerAlongFlowField(UEnemyFlowFieldSubsystem* FlowField)
+{
+	// Once the player is inside our CombatSphere we stand and fight instead of pushing into them
+	if (!bUseFlowField || bOverlappingCombatSphere || ChaseTarget == nullptr) return;
+
+	FVector Direction;
+	if (FlowField && FlowField->SampleDirection(GetActorLocation(), ChaseTarget->GetActorLocation(), Direction))
+	{
+		if (bFollowingNavPath)
+		{
+			// Back on the field, so we don't need our own path any more
+			bFollowingNavPath = false;
+			if (AIController)
+			{
+				AIController->StopMovement();
+			}
+		}
+		AddMovementInput(Direction);
+	}
+	else if (!bFollowingNavPath)
+	{
+		// Outside the field or somewhere it can't reach, find our own way there like we used to
+		RequestNavPath(ChaseTarget);
+	}
+}
+
 void AEnemy::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
 {
     if (OtherActor)
@@ -266,23 +410,13 @@ void AEnemy::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AAct
         AMain* Main = Cast<AMain>(OtherActor);
         if (Main)
         {
-            // Attempt to play the HitParticles
-            // So we need to check to make sure the HitParticles are working
-            if (Main->HitParticles)
+            // Same as the weapon, hit effects go through the impact subsystem so they get pooled and coalesced
+            UCombatImpactSubsystem* Impacts = GetWorld()->GetSubsystem<UCombatImpactSubsystem>();
+            if (Impacts)
             {
-                // reference to the socket we created on the weapon
-                const USkeletalMeshSocket* TipSocket = GetMesh()->GetSocketByName("TipSocket");
-                if (TipSocket)
-                {
-                    // Spawn the emitter at the location of our socket
-                    FVector SocketLocation = TipSocket->GetSocketLocation(GetMesh());
-                    UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Main->HitParticles, SocketLocation, FRotator(0.f), false);
-                    // This will spawn the particle system at our swords blade instead of the entire sword
-                }
-            }
-            if (Main->HitSound)
-            {
-                UGameplayStatics::PlaySound2D(this, Main->HitSound); // As long as the enemy has a hit sound on the blueprint, this will work
+                UParticleSystem* Particles = TipSocket ? Main->HitParticles : nullptr;
+                FVector SocketLocation = TipSocket ? TipSocket->GetSocketLocation(GetMesh()) : GetActorLocation();
+                Impacts->PlayImpact(Particles, Main->HitSound, SocketLocation);
             }
 			if (DamageTypeClass)
 			{
@@ -323,6 +457,7 @@ void AEnemy::Attack()
 		if (AIController)
 		{
 			AIController->StopMovement(); // Stop moving, focus on attacking
+			bFollowingNavPath = false;
 			SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Attacking);
 		}
 		if (!bAttacking) // If not already attacking, start attack anim montage
@@ -347,7 +482,10 @@ void AEnemy::AttackEnd()
 	{
 		// If PC is still inside of the CombatSphere, keep attacking
 		float AttackTime = FMath::FRandRange(AttackMinTime, AttackMaxTime); // Set a timer based on an AttackTime to wait between attacks
-		GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime); // This will make it attack, wait, then attack again
+		if (Director)
+		{
+			Director->ScheduleAttack(this, AttackTime); // This will make it attack, wait, then attack again
+		}
 		// Since it's already managed to turn OverlappingCombatSphere on and off in above functions we don't have to worry about it here
 		// This will handle if the monster will keep attacking or if it will stop attacking
 		// If we walk away and leave the sphere, this check will fail and the monster will not attack, the monsters will just continue to run towards the player
@@ -371,6 +509,14 @@ float AEnemy::TakeDamage(float DamageAmount, struct FDamageEvent const & DamageE
 void AEnemy::Die(AActor* Causer)
 {
 	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Death);
+
+	// If we were placed in the level, don't come back after a save and load
+	UWorldStateSubsystem* WorldState = GetGameInstance() ? GetGameInstance()->GetSubsystem<UWorldStateSubsystem>() : nullptr;
+	if (WorldState)
+	{
+		WorldState->RecordConsumed(this);
+	}
+
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 	if (AnimInstance)
 	{
@@ -397,11 +543,14 @@ void AEnemy::Die(AActor* Causer)
 void AEnemy::DeathEnd()
 {
 	// When enemy health reaches 0, forbid it from just getting back up, make sure it stays dead
-	GetMesh()->bPauseAnims = true;
-	GetMesh()->bNoSkeletonUpdate = true;
+	SetSkeletalUpdatesPaused(true);
 
 	// As soon as the enemy is killed, set the timer for the body to be despawned
-	GetWorldTimerManager().SetTimer(DeathTimer, this, &AEnemy::Despawn, DeathDelay);
+	UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+	if (Timers)
+	{
+		Timers->SetTimer(DeathTimer, this, &AEnemy::Despawn, DeathDelay);
+	}
 }
 
 bool AEnemy::Alive()
@@ -411,5 +560,104 @@ bool AEnemy::Alive()
 
 void AEnemy::Despawn()
 {
-	Destroy();
-}
\ No newline at end of file
+	// Pooled enemies go back to their pool to be spawned again later, everything else is gone for good
+	UEnemyPoolSubsystem* Pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	if (bPooled && Pool)
+	{
+		Pool->Release(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void AEnemy::SetPoolActive(bool bActive)
+{
+	SetActorHiddenInGame(!bActive);
+	SetActorEnableCollision(bActive);
+	GetMesh()->SetComponentTickEnabled(bActive);
+	GetCharacterMovement()->SetComponentTickEnabled(bActive);
+
+	if (AIController)
+	{
+		// We keep our AIController the whole time we're in the pool, it just stops doing anything
+		AIController->StopMovement();
+		AIController->SetActorTickEnabled(bActive);
+	}
+
+	if (bActive)
+	{
+		RegisterWithSubsystems();
+	}
+	else
+	{
+		GetCharacterMovement()->StopMovementImmediately();
+		UnregisterFromSubsystems();
+
+		// Make sure nothing we left running fires while we're sitting in the pool
+		UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+		if (Timers)
+		{
+			Timers->ClearTimer(DeathTimer);
+		}
+	}
+}
+
+void AEnemy::ResetForReuse()
+{
+	// Back to how a freshly spawned enemy of our class would start out
+	Health = GetClass()->GetDefaultObject<AEnemy>()->Health;
+
+	bAttacking = false;
+	bOverlappingCombatSphere = false;
+	bHasValidTarget = false;
+	bFollowingNavPath = false;
+	CombatTarget = nullptr;
+	ChaseTarget = nullptr;
+
+	SetEnemyMovementStatus(EEnemyMovementStatus::EMS_Idle);
+
+	// Undo what Die() and DeathEnd() did
+	GetCapsuleComponent()->SetCollisionEnabled(DefaultCapsuleCollision);
+	AggroSphere->SetCollisionEnabled(DefaultAggroSphereCollision);
+	CombatSphere->SetCollisionEnabled(DefaultCombatSphereCollision);
+	CombatCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	if (AnimInstance)
+	{
+		AnimInstance->Montage_Stop(0.f); // Don't come back mid way through the death animation
+	}
+
+	// Full detail until the AI LOD says otherwise. Also unfreezes the skeleton
+	ApplyAILOD(FEnemyAILODTier());
+}
+
+void AEnemy::SetSkeletalUpdatesPaused(bool bPaused)
+{
+	GetMesh()->bPauseAnims = bPaused;
+	GetMesh()->bNoSkeletonUpdate = bPaused;
+}
+
+void AEnemy::ApplyAILOD(const FEnemyAILODTier& Tier)
+{
+	// Corpses keep their collision off and their skeleton frozen no matter how close the player gets
+	if (!Alive()) return;
+
+	AggroSphere->SetGenerateOverlapEvents(Tier.bOverlapSpheres);
+	CombatSphere->SetGenerateOverlapEvents(Tier.bOverlapSpheres);
+
+	SetSkeletalUpdatesPaused(!Tier.bSkeletalUpdates);
+
+	// Slow down everything that still ticks on its own. A budgeted mesh has its tick rate managed by the animation budget allocator instead
+	if (!GetMesh()->IsA<USkeletalMeshComponentBudgeted>())
+	{
+		GetMesh()->SetComponentTickInterval(Tier.UpdateInterval);
+	}
+	GetCharacterMovement()->SetComponentTickInterval(Tier.UpdateInterval);
+	if (AIController)
+	{
+		AIController->SetActorTickInterval(Tier.UpdateInterval);
+	}
+}
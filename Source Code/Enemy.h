@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "GameplayTimingWheel.h"
 #include "Enemy.generated.h"
 
 UENUM(BlueprintType)
@@ -17,6 +18,29 @@ enum class EEnemyMovementStatus : uint8
 	EMS_MAX 			UMETA(DisplayName = "DefaultMAX")
 };
 
+USTRUCT(BlueprintType)
+struct FEnemyAILODTier
+{
+	// One level of detail for enemy AI. The enemy director picks a tier for every enemy based on how far it is from the player
+	GENERATED_BODY()
+
+	/** Enemies closer than this to the player use this tier (the last tier catches everything further out) */
+	UPROPERTY(EditAnywhere, Category = "AI LOD")
+	float MaxDistance = 0.f;
+
+	/** How often the enemy, its movement and its AIController update. 0 means every frame */
+	UPROPERTY(EditAnywhere, Category = "AI LOD")
+	float UpdateInterval = 0.f;
+
+	/** Whether AggroSphere and CombatSphere generate overlap events. Needs to stay on for any tier the player can actually aggro in */
+	UPROPERTY(EditAnywhere, Category = "AI LOD")
+	bool bOverlapSpheres = true;
+
+	/** Whether the skeletal mesh keeps animating */
+	UPROPERTY(EditAnywhere, Category = "AI LOD")
+	bool bSkeletalUpdates = true;
+};
+
 UCLASS()
 class MYPROJECT_API AEnemy : public ACharacter
 {
@@ -24,12 +48,13 @@ class MYPROJECT_API AEnemy : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	AEnemy();
+	// Takes the ObjectInitializer so the mesh can be swapped for a budgeted one, see UEnemyDirectorSubsystem::AnimationBudgetMs
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
 	EEnemyMovementStatus EnemyMovementStatus;
 
-	FORCEINLINE void SetEnemyMovementStatus(EEnemyMovementStatus Status) { EnemyMovementStatus = Status; } // Setter
+	void SetEnemyMovementStatus(EEnemyMovementStatus Status); // Setter, also keeps the enemy director in sync
 	// Getter
 	FORCEINLINE EEnemyMovementStatus GetEnemyMovementStatus() { return EnemyMovementStatus; }
 
@@ -72,7 +97,17 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Combat")
 	class UAnimMontage* CombatMontage;
 
-	FTimerHandle AttackTimer; // This will be a way to give the enemy a random time to wait to attack, to give the player time to dodge and move out of the way
+	/** TipSocket on our mesh, looked up once in BeginPlay instead of on every hit */
+	UPROPERTY(Transient)
+	const class USkeletalMeshSocket* TipSocket;
+
+	// The random wait before each attack (to give the player time to dodge and move out of the way) is run by the enemy director now, instead of an FTimerHandle per enemy
+
+	/** The director that batches our updates, and our slot in its arrays */
+	UPROPERTY(Transient)
+	class UEnemyDirectorSubsystem* Director;
+
+	int32 DirectorIndex;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	float AttackMinTime; // Minimum time to wait before attacking
@@ -83,7 +118,7 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	TSubclassOf<UDamageType> DamageTypeClass; // This way when we do ApplyDamage() we have something to pass in to one of the required params
 
-	FTimerHandle DeathTimer; // This and the below DeathDelay will be used to despawn enemy corpses after a set time, to not take up memory
+	FGameplayTimerHandle DeathTimer; // This and the below DeathDelay will be used to despawn enemy corpses after a set time, to not take up memory
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	float DeathDelay;
@@ -94,6 +129,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -118,6 +155,22 @@ public:
 	void MoveToTarget(class AMain* Target); // Want this to move to the player
 	// Want to hold off calling this if our animation is not finished
 
+	/** When true we chase by following the shared flow field towards the player instead of asking the navmesh for our own path */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	bool bUseFlowField;
+
+	/** Who we're chasing, kept so we can fall back on a normal path if we wander off the flow field */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
+	AMain* ChaseTarget;
+
+	bool bFollowingNavPath; // True while a regular MoveTo request is driving us
+
+	/** Asks the AIController for our own navmesh path to Target, the way we always used to chase */
+	void RequestNavPath(AMain* Target);
+
+	/** Called from the enemy director while we're chasing, adds movement input along the flow field */
+	void SteerAlongFlowField(class UEnemyFlowFieldSubsystem* FlowField);
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "AI")
 	bool bOverlappingCombatSphere;
 
@@ -156,4 +209,28 @@ public:
 	bool Alive();
 
 	void Despawn();
+
+	/** Freeze or unfreeze the skeleton. Used for corpses in DeathEnd and for far away enemies by the AI LOD */
+	void SetSkeletalUpdatesPaused(bool bPaused);
+
+	/** Called by the enemy director when we move into a different AI LOD tier */
+	void ApplyAILOD(const FEnemyAILODTier& Tier);
+
+	// Spatial index and enemy director registration. Done in BeginPlay/EndPlay, and whenever we go in and out of a pool
+	void RegisterWithSubsystems();
+	void UnregisterFromSubsystems();
+
+	/** True if we came from a UEnemyPoolSubsystem, so Despawn() hands us back instead of destroying us */
+	bool bPooled;
+
+	/** Hides us and stops everything from updating while we're in the pool, or brings us back */
+	void SetPoolActive(bool bActive);
+
+	/** Puts health, collision, state and anims back the way they were when we first spawned */
+	void ResetForReuse();
+
+	// Collision settings from BeginPlay, so ResetForReuse can undo what Die() turned off
+	ECollisionEnabled::Type DefaultCapsuleCollision;
+	ECollisionEnabled::Type DefaultAggroSphereCollision;
+	ECollisionEnabled::Type DefaultCombatSphereCollision;
 };
@@ -4,43 +4,61 @@
 #include "EnemyAnimInstance.h"
 #include "Enemy.h"
 
+void FEnemyAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+    FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+    // Game thread: grab the velocity; everything else happens on the worker
+    UEnemyAnimInstance* EnemyAnimInstance = CastChecked<UEnemyAnimInstance>(InAnimInstance);
+    if (EnemyAnimInstance->Pawn == nullptr)
+    {
+        EnemyAnimInstance->CacheOwner();
+    }
+
+    Velocity = EnemyAnimInstance->Pawn ? EnemyAnimInstance->Pawn->GetVelocity() : FVector::ZeroVector;
+}
+
+void FEnemyAnimInstanceProxy::Update(float DeltaSeconds)
+{
+    FAnimInstanceProxy::Update(DeltaSeconds);
+
+    // Worker thread, right before the anim graph update. The game thread doesn't touch the instance meanwhile
+    UEnemyAnimInstance* EnemyAnimInstance = CastChecked<UEnemyAnimInstance>(GetAnimInstanceObject());
+    EnemyAnimInstance->MovementSpeed = Velocity.Size2D();
+}
+
 void UEnemyAnimInstance::NativeInitializeAnimation()
 {
     if (Pawn == nullptr)
     {
-        Pawn = TryGetPawnOwner(); // Try to get the pawn that owns this class
-        // If that's valid, set it equal to Pawn
-        if (Pawn)
-        {
-            Enemy = Cast<AEnemy>(Pawn); // A reference to the enemy and a pawn initialization
-        }
+        CacheOwner();
     }
 }
 
-void UEnemyAnimInstance::UpdateAnimationProperties()
+FAnimInstanceProxy* UEnemyAnimInstance::CreateAnimInstanceProxy()
+{
+    // Default DestroyAnimInstanceProxy deletes it for us
+    return new FEnemyAnimInstanceProxy(this);
+}
+
+void UEnemyAnimInstance::CacheOwner()
+{
+    Pawn = TryGetPawnOwner(); // Try to get the pawn that owns this class
+    // If that's valid, set it equal to Pawn
+    Enemy = Pawn ? Cast<AEnemy>(Pawn) : nullptr; // A reference to the enemy and a pawn initialization
+}
+
+void UEnemyAnimInstance::UpdateAnimationProperties() // Legacy; the proxy does this now
 {
     // CHeck to see if the above values are valid and if they're not, try to set them here as well
     if (Pawn == nullptr)
     {
-        Pawn = TryGetPawnOwner(); // Try to get the pawn that owns this class
-        // If that's valid, set it equal to Pawn
-        if (Pawn)
-        { 
-            Enemy = Cast<AEnemy>(Pawn); // A reference to the enemy and a pawn initialization
-        }
-    } 
+        CacheOwner();
+    }
 
     if (Pawn)
     {
-        // Update our speed before we Cast to our Enemy
-        FVector Speed = Pawn->GetVelocity(); // Get from the Pawn how fast it's going at that time/frame
-        FVector LateralSpeed = FVector(Speed.X, Speed.Y, 0.f);
-        MovementSpeed = LateralSpeed.Size(); // Will give us the magnitude of that vector as a float
-
-        // This way our speed is set and ready to be accessed in our AnimBlueprint
-
-        // Need to move our speed down to here so that way movement speed will actually update, because otherwise the check would fail every time
+        // Get from the Pawn how fast it's going at that time/frame, ignoring the vertical part
+        MovementSpeed = Pawn->GetVelocity().Size2D(); // Will give us the magnitude of that vector as a float
     }
-
-    // This way we'll be sure that we'll have our Pawn and our Enemy as well
-}
\ No newline at end of file
+}
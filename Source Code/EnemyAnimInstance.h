@@ -4,8 +4,34 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "EnemyAnimInstance.generated.h"
 
+/**
+ * Proxy for UEnemyAnimInstance. Snapshots the pawn velocity on the game thread in PreUpdate and writes
+ * MovementSpeed on the animation worker thread in Update, ahead of the anim graph update.
+ */
+struct FEnemyAnimInstanceProxy : public FAnimInstanceProxy
+{
+	FEnemyAnimInstanceProxy()
+		: FAnimInstanceProxy()
+	{
+	}
+
+	FEnemyAnimInstanceProxy(UAnimInstance* InAnimInstance)
+		: FAnimInstanceProxy(InAnimInstance)
+	{
+	}
+
+protected:
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+	virtual void Update(float DeltaSeconds) override;
+
+private:
+	// Game thread snapshot, consumed on the worker thread
+	FVector Velocity = FVector::ZeroVector;
+};
+
 /**
  * 
  */
@@ -16,6 +42,8 @@ class MYPROJECT_API UEnemyAnimInstance : public UAnimInstance
 public:
 	virtual void NativeInitializeAnimation() override; // This will be similar to BeginPlay for us
 
+	// Kept for AnimBPs whose event graph still calls this every frame. The proxy already fills in MovementSpeed
+	// on the worker thread, so new AnimBPs should leave the event graph empty
 	UFUNCTION(BlueprintCallable, Category = "AnimationProperties") // Can give functions a UFUNCTION tag and, just like UPROPERTY, can have them work with blueprints
 	void UpdateAnimationProperties();
 
@@ -29,5 +57,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Movement")
 	class AEnemy* Enemy; 
 	// Above two will be to reference the pawn and the main Enemy instance that owns this AnimInstance
-	
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+
+private:
+	/** Looks up Pawn and Enemy from the owner every time it's called; callers only call it while Pawn is still null. */
+	void CacheOwner();
+
+	friend struct FEnemyAnimInstanceProxy;
 };
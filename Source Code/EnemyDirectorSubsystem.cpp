@@ -0,0 +1,312 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyDirectorSubsystem.h"
+#include "MyProject.h"
+#include "Main.h"
+#include "EnemyFlowFieldSubsystem.h"
+#include "GameplayTimerSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "IAnimationBudgetAllocator.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Director Tick"), STAT_EnemyDirectorTick, STATGROUP_MyProject);
+DECLARE_CYCLE_STAT(TEXT("Enemy AI LOD Evaluate"), STAT_EnemyAILODEvaluate, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Directed"), STAT_EnemiesDirected, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Tier 0 (Near)"), STAT_AILODTier0, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Tier 1"), STAT_AILODTier1, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Tier 2"), STAT_AILODTier2, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Tier 3+"), STAT_AILODTier3, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Anims Throttled"), STAT_EnemyAnimsThrottled, STATGROUP_MyProject);
+
+static void SetAnimationBudgetCommand(const TArray<FString>& Args, UWorld* World)
+{
+	UEnemyDirectorSubsystem* Director = World ? World->GetSubsystem<UEnemyDirectorSubsystem>() : nullptr;
+	if (Director == nullptr) return;
+
+	if (Args.Num() > 0)
+	{
+		Director->SetAnimationBudget(FCString::Atof(*Args[0]));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Enemy animation budget: %.2f ms (%d of %d enemies throttled)"),
+		Director->AnimationBudgetMs, Director->GetNumAnimationThrottled(), Director->GetNumEnemies());
+}
+
+static FAutoConsoleCommandWithWorldAndArgs AnimationBudgetCommand(
+	TEXT("MyProject.AnimBudget"),
+	TEXT("Sets the per frame animation budget for enemy meshes in milliseconds, 0 turns it off. Usage: MyProject.AnimBudget [Ms]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SetAnimationBudgetCommand));
+
+UEnemyDirectorSubsystem::UEnemyDirectorSubsystem()
+{
+	// Default tiers, the ini can replace these
+	// Near: everything at full rate. Mid: slower updates but still able to aggro. Far: frozen skeleton, no overlaps, twice a second
+	// The mid tier has to reach past the AggroSphere radius (600) or the player could walk into an aggro sphere that isn't listening
+	FEnemyAILODTier Near;
+	Near.MaxDistance = 1500.f;
+	LODTiers.Add(Near);
+
+	FEnemyAILODTier Mid;
+	Mid.MaxDistance = 4000.f;
+	Mid.UpdateInterval = 0.1f;
+	LODTiers.Add(Mid);
+
+	FEnemyAILODTier Far;
+	Far.MaxDistance = MAX_flt;
+	Far.UpdateInterval = 0.5f;
+	Far.bOverlapSpheres = false;
+	Far.bSkeletalUpdates = false;
+	LODTiers.Add(Far);
+
+	LODEvaluationInterval = 0.25f;
+	LODHysteresis = 0.1f;
+	TimeUntilLODEvaluation = 0.f;
+
+	AnimationBudgetMs = 1.f;
+	NumAnimationThrottled = 0;
+}
+
+void UEnemyDirectorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ApplyAnimationBudget();
+}
+
+void UEnemyDirectorSubsystem::SetAnimationBudget(float BudgetMs)
+{
+	AnimationBudgetMs = FMath::Max(BudgetMs, 0.f);
+	ApplyAnimationBudget();
+}
+
+void UEnemyDirectorSubsystem::ApplyAnimationBudget()
+{
+	UWorld* World = GetWorld();
+	IAnimationBudgetAllocator* Allocator = World ? IAnimationBudgetAllocator::Get(World) : nullptr;
+	if (Allocator == nullptr) return;
+
+	if (AnimationBudgetMs > 0.f)
+	{
+		FAnimationBudgetAllocatorParameters Parameters; // Engine defaults for everything but the budget itself
+		Parameters.BudgetInMs = AnimationBudgetMs;
+		Allocator->SetParameters(Parameters);
+	}
+	Allocator->SetEnabled(AnimationBudgetMs > 0.f);
+}
+
+void UEnemyDirectorSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || IsValidSlot(Enemy)) return;
+
+	// Every array gets one new entry at the same index
+	Enemy->DirectorIndex = Enemies.Add(Enemy);
+	Alive.Add(Enemy->Alive());
+	MovementStatus.Add(Enemy->GetEnemyMovementStatus());
+	Targets.Add(Enemy->CombatTarget);
+	AttackTimers.AddDefaulted();
+	LODTier.Add(0); // Everyone starts at full detail until the next evaluation says otherwise
+	PendingDeltaTime.Add(0.f);
+}
+
+void UEnemyDirectorSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (!IsValidSlot(Enemy)) return;
+
+	const int32 Index = Enemy->DirectorIndex;
+
+	CancelAttack(Enemy);
+
+	// Swap the last enemy into this slot so the arrays stay packed
+	Enemies.RemoveAtSwap(Index, 1, false);
+	Alive.RemoveAtSwap(Index, 1, false);
+	MovementStatus.RemoveAtSwap(Index, 1, false);
+	Targets.RemoveAtSwap(Index, 1, false);
+	AttackTimers.RemoveAtSwap(Index, 1, false);
+	LODTier.RemoveAtSwap(Index, 1, false);
+	PendingDeltaTime.RemoveAtSwap(Index, 1, false);
+
+	if (Enemies.IsValidIndex(Index))
+	{
+		Enemies[Index]->DirectorIndex = Index;
+	}
+	Enemy->DirectorIndex = INDEX_NONE;
+}
+
+bool UEnemyDirectorSubsystem::IsValidSlot(AEnemy* Enemy) const
+{
+	return Enemy && Enemies.IsValidIndex(Enemy->DirectorIndex) && Enemies[Enemy->DirectorIndex] == Enemy;
+}
+
+void UEnemyDirectorSubsystem::SetMovementStatus(AEnemy* Enemy, EEnemyMovementStatus Status)
+{
+	if (!IsValidSlot(Enemy)) return;
+
+	const int32 Index = Enemy->DirectorIndex;
+	MovementStatus[Index] = Status;
+	Alive[Index] = Status != EEnemyMovementStatus::EMS_Death;
+
+	if (!Alive[Index])
+	{
+		// Dead enemies don't get to finish their swing
+		CancelAttack(Enemy);
+	}
+}
+
+void UEnemyDirectorSubsystem::SetTarget(AEnemy* Enemy, AMain* Target)
+{
+	if (IsValidSlot(Enemy))
+	{
+		Targets[Enemy->DirectorIndex] = Target;
+	}
+}
+
+void UEnemyDirectorSubsystem::ScheduleAttack(AEnemy* Enemy, float Delay)
+{
+	UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+	if (IsValidSlot(Enemy) && Timers)
+	{
+		// Same as SetTimer on a handle, scheduling again just replaces whatever was pending
+		Timers->SetTimer(AttackTimers[Enemy->DirectorIndex], Enemy, &AEnemy::Attack, Delay);
+	}
+}
+
+void UEnemyDirectorSubsystem::CancelAttack(AEnemy* Enemy)
+{
+	UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+	if (IsValidSlot(Enemy) && Timers)
+	{
+		Timers->ClearTimer(AttackTimers[Enemy->DirectorIndex]);
+	}
+}
+
+bool UEnemyDirectorSubsystem::IsTickable() const
+{
+	// The CDO never ticks, and there's nothing to do with an empty level
+	return !IsTemplate() && Enemies.Num() > 0;
+}
+
+TStatId UEnemyDirectorSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_EnemyDirectorTick); // The tickable manager scopes our Tick with this
+}
+
+void UEnemyDirectorSubsystem::Tick(float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_EnemiesDirected, Enemies.Num());
+
+	TimeUntilLODEvaluation -= DeltaTime;
+	if (TimeUntilLODEvaluation <= 0.f)
+	{
+		TimeUntilLODEvaluation = LODEvaluationInterval;
+		EvaluateLOD();
+	}
+
+	// Chasing enemies all share one flow field towards the player, which only rebuilds once the player has moved far enough
+	// With nobody chasing there's nothing to build it for, so it isn't even looked at
+	UEnemyFlowFieldSubsystem* FlowField = GetWorld()->GetSubsystem<UEnemyFlowFieldSubsystem>();
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (FlowField && Player && MovementStatus.Contains(EEnemyMovementStatus::EMS_MoveToTarget))
+	{
+		FlowField->UpdateGoal(Player->GetActorLocation());
+	}
+
+	// One tight pass over the enemies, only touching actors that actually need to do something this frame
+	// (attacks aren't in here any more, the timer wheel calls those straight away when they're due)
+	for (int32 i = 0; i < Enemies.Num(); i++)
+	{
+		if (!Alive[i]) continue;
+
+		// Lower tiers bank their time and catch up in one bigger step
+		PendingDeltaTime[i] += DeltaTime;
+		const float UpdateInterval = LODTiers.IsValidIndex(LODTier[i]) ? LODTiers[LODTier[i]].UpdateInterval : 0.f;
+		if (PendingDeltaTime[i] < UpdateInterval) continue;
+
+		PendingDeltaTime[i] = 0.f;
+
+		if (MovementStatus[i] == EEnemyMovementStatus::EMS_MoveToTarget && FlowField)
+		{
+			Enemies[i]->SteerAlongFlowField(FlowField);
+		}
+	}
+}
+
+int32 UEnemyDirectorSubsystem::PickTier(float DistanceSquared, int32 CurrentTier) const
+{
+	for (int32 Tier = 0; Tier < LODTiers.Num() - 1; Tier++)
+	{
+		float Boundary = LODTiers[Tier].MaxDistance;
+		if (Tier < CurrentTier)
+		{
+			// Coming back in towards the player, make it cross the boundary properly first
+			Boundary *= (1.f - LODHysteresis);
+		}
+
+		if (DistanceSquared <= FMath::Square(Boundary))
+		{
+			return Tier;
+		}
+	}
+	return LODTiers.Num() - 1;
+}
+
+void UEnemyDirectorSubsystem::EvaluateLOD()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyAILODEvaluate);
+
+	if (LODTiers.Num() == 0) return;
+
+	// Significance is just distance to the player for us
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (Player == nullptr) return;
+
+	const FVector PlayerLocation = Player->GetActorLocation();
+
+	TierCounts.Reset();
+	TierCounts.AddZeroed(LODTiers.Num());
+	NumAnimationThrottled = 0;
+
+	for (int32 i = 0; i < Enemies.Num(); i++)
+	{
+		if (!Alive[i]) continue;
+
+		const float DistanceSquared = FVector::DistSquared(Enemies[i]->GetActorLocation(), PlayerLocation);
+		const int32 NewTier = PickTier(DistanceSquared, LODTier[i]);
+		if (NewTier != LODTier[i])
+		{
+			LODTier[i] = NewTier;
+			Enemies[i]->ApplyAILOD(LODTiers[NewTier]);
+		}
+		TierCounts[NewTier]++;
+
+		// Closer is more significant. Anyone with a target keeps animating every frame, their attacks are driven by anim notifies
+		USkeletalMeshComponent* Mesh = Enemies[i]->GetMesh();
+		USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(Mesh);
+		if (BudgetedMesh)
+		{
+			const bool bEngaged = Targets[i] != nullptr;
+			BudgetedMesh->SetComponentSignificance(1.f / FMath::Max(DistanceSquared, 1.f), bEngaged);
+		}
+		if (Mesh->AnimUpdateRateParams && Mesh->AnimUpdateRateParams->UpdateRate > 1)
+		{
+			NumAnimationThrottled++;
+		}
+	}
+	SET_DWORD_STAT(STAT_EnemyAnimsThrottled, NumAnimationThrottled);
+
+	SET_DWORD_STAT(STAT_AILODTier0, GetNumEnemiesInTier(0));
+	SET_DWORD_STAT(STAT_AILODTier1, GetNumEnemiesInTier(1));
+	SET_DWORD_STAT(STAT_AILODTier2, GetNumEnemiesInTier(2));
+
+	int32 FurtherOut = 0;
+	for (int32 Tier = 3; Tier < TierCounts.Num(); Tier++)
+	{
+		FurtherOut += TierCounts[Tier];
+	}
+	SET_DWORD_STAT(STAT_AILODTier3, FurtherOut);
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Enemy.h"
+#include "GameplayTimingWheel.h"
+#include "EnemyDirectorSubsystem.generated.h"
+
+/**
+ * Owns every AEnemy in the world and updates them together in one tick, instead of each enemy ticking and running its own timers
+ * State the batch update needs is kept in parallel arrays, indexed by AEnemy::DirectorIndex
+ * It also runs the AI LOD, dropping enemies far from the player to cheaper update tiers, and feeds the same distances
+ * to the animation budget allocator as significance
+ */
+UCLASS(Config = Game)
+class MYPROJECT_API UEnemyDirectorSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyDirectorSubsystem();
+
+	/** AI LOD tiers, nearest first. Set in DefaultGame.ini under [/Script/MyProject.EnemyDirectorSubsystem] */
+	UPROPERTY(Config)
+	TArray<FEnemyAILODTier> LODTiers;
+
+	/** How often we re-check which tier every enemy belongs in */
+	UPROPERTY(Config)
+	float LODEvaluationInterval;
+
+	/** Moving back towards a nearer tier has to beat the boundary by this fraction, so enemies sitting on a boundary don't flicker between tiers */
+	UPROPERTY(Config)
+	float LODHysteresis;
+
+	/** Total game thread time per frame the animation budget allocator may spend on enemy meshes. Over budget, the least significant ones update less often and interpolate. 0 turns the budget off */
+	UPROPERTY(Config)
+	float AnimationBudgetMs;
+
+	/** Changes the animation budget at runtime. Also what the MyProject.AnimBudget console command calls */
+	void SetAnimationBudget(float BudgetMs);
+
+	/** How many enemy meshes the animation budget allocator had running below full rate at the last AI LOD evaluation */
+	FORCEINLINE int32 GetNumAnimationThrottled() const { return NumAnimationThrottled; }
+
+	// USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	// Enemies push their state here whenever it changes, so the batch update never has to go back to the actor to read it
+	void SetMovementStatus(AEnemy* Enemy, EEnemyMovementStatus Status);
+	void SetTarget(AEnemy* Enemy, class AMain* Target);
+
+	/** Replaces the per-enemy AttackTimer. Calls Enemy->Attack() once Delay seconds have passed, using the gameplay timer wheel */
+	void ScheduleAttack(AEnemy* Enemy, float Delay);
+	void CancelAttack(AEnemy* Enemy);
+
+	FORCEINLINE int32 GetNumEnemies() const { return Enemies.Num(); }
+
+	/** How many enemies are currently in the given AI LOD tier */
+	FORCEINLINE int32 GetNumEnemiesInTier(int32 Tier) const { return TierCounts.IsValidIndex(Tier) ? TierCounts[Tier] : 0; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	bool IsValidSlot(AEnemy* Enemy) const;
+
+	/** Puts every enemy in the right tier for its distance to the player and applies any changes */
+	void EvaluateLOD();
+
+	int32 PickTier(float DistanceSquared, int32 CurrentTier) const;
+
+	/** Pushes AnimationBudgetMs to this world's animation budget allocator */
+	void ApplyAnimationBudget();
+
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+
+	TArray<bool> Alive;
+	TArray<EEnemyMovementStatus> MovementStatus;
+
+	UPROPERTY()
+	TArray<AMain*> Targets;
+
+	TArray<FGameplayTimerHandle> AttackTimers; // Pending attack for each enemy, if any
+
+	TArray<uint8> LODTier; // Index into LODTiers
+	TArray<float> PendingDeltaTime; // Time banked up since this enemy was last updated, for tiers that don't update every frame
+
+	TArray<int32> TierCounts;
+
+	float TimeUntilLODEvaluation;
+
+	int32 NumAnimationThrottled;
+};
@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyFlowFieldSubsystem.h"
+#include "MyProject.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Rebuild"), STAT_FlowFieldRebuild, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Flow Field Rebuilds"), STAT_FlowFieldRebuilds, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Flow Field Nav Queries"), STAT_FlowFieldNavQueries, STATGROUP_MyProject);
+
+// The 8 neighbours of a cell, and which of them points back the other way
+static const int32 NeighbourOffsetX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int32 NeighbourOffsetY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+static const int32 OppositeNeighbour[8] = { 1, 0, 3, 2, 7, 6, 5, 4 };
+
+const uint8 UEnemyFlowFieldSubsystem::NoNextHop;
+
+UEnemyFlowFieldSubsystem::UEnemyFlowFieldSubsystem()
+{
+	CellSize = 100.f;
+	HalfExtent = 40; // 81x81 cells, 8000 units across, which covers the furthest an aggro'd enemy usually chases from
+	RebuildDistance = 200.f;
+	MaxStepHeight = 60.f;
+	BuildBudgetMs = 0.5f;
+	ReprojectHeight = 125.f; // Half the height of the projection query
+
+	FieldOrigin = FVector::ZeroVector;
+	Goal = FVector::ZeroVector;
+	bHasField = false;
+
+	bBuilding = false;
+	BuildGoal = FVector::ZeroVector;
+	BuildMinCell = FIntPoint::ZeroValue;
+}
+
+void UEnemyFlowFieldSubsystem::UpdateGoal(const FVector& GoalLocation)
+{
+	// A build that's already going gets finished first, even if the goal has moved on since. It's only a few frames old
+	if (!bBuilding && (!bHasField || FVector::DistSquared(GoalLocation, Goal) > FMath::Square(RebuildDistance)))
+	{
+		StartBuild(GoalLocation);
+	}
+
+	if (bBuilding)
+	{
+		ContinueBuild();
+	}
+}
+
+int32 UEnemyFlowFieldSubsystem::GetCellIndex(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt((Location.X - FieldOrigin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt((Location.Y - FieldOrigin.Y) / CellSize);
+	const int32 Width = GetGridWidth();
+	if (X < 0 || Y < 0 || X >= Width || Y >= Width) return INDEX_NONE;
+
+	return Y * Width + X;
+}
+
+void UEnemyFlowFieldSubsystem::StartBuild(const FVector& GoalLocation)
+{
+	const int32 Width = GetGridWidth();
+	const int32 NumCells = Width * Width;
+	if (CellCache.Num() != NumCells)
+	{
+		CellCache.Reset();
+		CellCache.SetNum(NumCells);
+	}
+
+	// The grid is lined up with world cells rather than centred exactly on the goal, so cells keep their cached answers as it scrolls
+	BuildGoal = GoalLocation;
+	BuildMinCell = GetWorldCell(GoalLocation) - FIntPoint(HalfExtent, HalfExtent);
+
+	BuildDistances.Init(MAX_flt, NumCells);
+	BuildNextHops.Init(NoNextHop, NumCells);
+	BuildOpen.Reset();
+
+	const int32 GoalIndex = HalfExtent * Width + HalfExtent;
+	BuildDistances[GoalIndex] = 0.f;
+	BuildOpen.HeapPush({ GoalIndex, 0.f });
+
+	bBuilding = true;
+}
+
+void UEnemyFlowFieldSubsystem::ContinueBuild()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldRebuild);
+
+	UNavigationSystemV1* NavSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSystem ? NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (NavData == nullptr)
+	{
+		bBuilding = false;
+		bHasField = false;
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = BuildBudgetMs / 1000.0;
+	const int32 Width = GetGridWidth();
+	const float DiagonalCost = CellSize * FMath::Sqrt(2.f);
+
+	// Dijkstra outwards from the goal over the 8 neighbours of each cell. The navmesh is only asked about cells the flood actually
+	// reaches, so space behind a wall never costs anything
+	while (BuildOpen.Num() > 0)
+	{
+		FOpenCell Current;
+		BuildOpen.HeapPop(Current, false);
+		if (Current.Distance > BuildDistances[Current.Index]) continue; // Stale entry, we already found a shorter way here
+
+		const int32 X = Current.Index % Width;
+		const int32 Y = Current.Index / Width;
+		const FIntPoint Cell = BuildMinCell + FIntPoint(X, Y);
+
+		for (int32 n = 0; n < 8; n++)
+		{
+			const int32 NX = X + NeighbourOffsetX[n];
+			const int32 NY = Y + NeighbourOffsetY[n];
+			if (NX < 0 || NY < 0 || NX >= Width || NY >= Width) continue;
+
+			// Cheap check first, no point asking the navmesh about an edge that wouldn't be an improvement anyway
+			const int32 Neighbour = NY * Width + NX;
+			const float Distance = Current.Distance + (n < 4 ? CellSize : DiagonalCost);
+			if (Distance >= BuildDistances[Neighbour]) continue;
+			if (!IsLinked(Cell, n, NavData)) continue;
+
+			// A diagonal only counts if both the straight moves round it are open too, otherwise it clips the corner of a wall
+			if (n >= 4 && (!IsLinked(Cell, NeighbourOffsetX[n] > 0 ? 0 : 1, NavData) || !IsLinked(Cell, NeighbourOffsetY[n] > 0 ? 2 : 3, NavData))) continue;
+
+			// We got there from here, so that's the way back towards the goal
+			BuildDistances[Neighbour] = Distance;
+			BuildNextHops[Neighbour] = OppositeNeighbour[n];
+			BuildOpen.HeapPush({ Neighbour, Distance });
+		}
+
+		if (FPlatformTime::Seconds() - StartTime >= BudgetSeconds) return;
+	}
+
+	// Done, swap it in for the one enemies have been steering by
+	Swap(Distances, BuildDistances);
+	Swap(NextHops, BuildNextHops);
+	FieldOrigin = FVector(BuildMinCell.X * CellSize, BuildMinCell.Y * CellSize, BuildGoal.Z);
+	Goal = BuildGoal;
+	bHasField = true;
+	bBuilding = false;
+
+	INC_DWORD_STAT(STAT_FlowFieldRebuilds);
+}
+
+UEnemyFlowFieldSubsystem::FFlowFieldCell& UEnemyFlowFieldSubsystem::EnsureProjected(const FIntPoint& Coord, const ANavigationData* NavData)
+{
+	FFlowFieldCell& Slot = CellCache[GetCacheSlot(Coord)];
+	if (Slot.Coord == Coord && FMath::Abs(Slot.QueryZ - BuildGoal.Z) <= ReprojectHeight) return Slot;
+
+	Slot = FFlowFieldCell();
+	Slot.Coord = Coord;
+	Slot.QueryZ = BuildGoal.Z;
+
+	// Anything next door that had worked out a link to this cell did it against whatever projection was here before
+	for (int32 n = 0; n < 8; n++)
+	{
+		FFlowFieldCell& Other = CellCache[GetCacheSlot(Coord + FIntPoint(NeighbourOffsetX[n], NeighbourOffsetY[n]))];
+		if (Other.Coord == Coord + FIntPoint(NeighbourOffsetX[n], NeighbourOffsetY[n]))
+		{
+			Other.LinksKnown &= ~(1 << OppositeNeighbour[n]);
+			Other.LinksOpen &= ~(1 << OppositeNeighbour[n]);
+		}
+	}
+
+	// Project the middle of the cell down onto the navmesh
+	const FVector CellCentre((Coord.X + 0.5f) * CellSize, (Coord.Y + 0.5f) * CellSize, BuildGoal.Z);
+	const FVector QueryExtent(CellSize * 0.5f, CellSize * 0.5f, 250.f);
+	FNavLocation NavLocation;
+	Slot.bWalkable = NavData->ProjectPoint(CellCentre, NavLocation, QueryExtent, NavData->GetDefaultQueryFilter());
+	Slot.NavLocation = NavLocation.Location;
+	INC_DWORD_STAT(STAT_FlowFieldNavQueries);
+
+	return Slot;
+}
+
+bool UEnemyFlowFieldSubsystem::IsLinked(const FIntPoint& Cell, int32 Direction, const ANavigationData* NavData)
+{
+	const FIntPoint OtherCell = Cell + FIntPoint(NeighbourOffsetX[Direction], NeighbourOffsetY[Direction]);
+	FFlowFieldCell& From = EnsureProjected(Cell, NavData);
+	FFlowFieldCell& To = EnsureProjected(OtherCell, NavData);
+
+	if (!To.bWalkable) return false;
+
+	// The player is standing in the goal cell even if the projection missed it (mid jump, say), so let the flood out of it
+	if (!From.bWalkable)
+	{
+		return Cell == GetWorldCell(BuildGoal);
+	}
+
+	const uint8 Bit = 1 << Direction;
+	if (From.LinksKnown & Bit) return (From.LinksOpen & Bit) != 0;
+
+	bool bOpen = FMath::Abs(To.NavLocation.Z - From.NavLocation.Z) <= MaxStepHeight;
+	if (bOpen)
+	{
+		// Two walkable cells either side of a wall or a gap are only connected if the navmesh gets from one to the other
+		FVector HitLocation;
+		bOpen = !NavData->Raycast(From.NavLocation, To.NavLocation, HitLocation, NavData->GetDefaultQueryFilter());
+		INC_DWORD_STAT(STAT_FlowFieldNavQueries);
+	}
+
+	// Same answer from the other side, so save it there too
+	const uint8 BackBit = 1 << OppositeNeighbour[Direction];
+	From.LinksKnown |= Bit;
+	To.LinksKnown |= BackBit;
+	if (bOpen)
+	{
+		From.LinksOpen |= Bit;
+		To.LinksOpen |= BackBit;
+	}
+
+	return bOpen;
+}
+
+bool UEnemyFlowFieldSubsystem::SampleDirection(const FVector& Location, const FVector& GoalLocation, FVector& OutDirection) const
+{
+	if (!bHasField) return false;
+
+	const int32 Index = GetCellIndex(Location);
+	if (Index == INDEX_NONE || Distances[Index] == MAX_flt) return false;
+
+	const int32 Width = GetGridWidth();
+	const uint8 NextHop = NextHops[Index];
+
+	// Follow the way the flood came, which is always a link the navmesh said was open. In the goal's cell, walk straight at wherever the goal is now
+	FVector Target = GoalLocation;
+	if (NextHop != NoNextHop)
+	{
+		const int32 NX = Index % Width + NeighbourOffsetX[NextHop];
+		const int32 NY = Index / Width + NeighbourOffsetY[NextHop];
+		Target = FieldOrigin + FVector((NX + 0.5f) * CellSize, (NY + 0.5f) * CellSize, 0.f);
+	}
+
+	OutDirection = FVector(Target.X - Location.X, Target.Y - Location.Y, 0.f).GetSafeNormal();
+	return true;
+}
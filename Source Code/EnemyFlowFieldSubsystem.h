@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyFlowFieldSubsystem.generated.h"
+
+/**
+ * One shared flow field towards the player, so enemies chasing them don't each need their own navmesh path
+ * A grid around the player is flooded outwards from the player's cell, and each cell remembers which neighbour the flood reached it
+ * from, so every enemy steers to the next cell on its shortest way to the player. Two cells are only connected if a navmesh raycast
+ * gets from one to the other, so walls, railings and gaps between navmesh islands stay walls, and diagonals don't cut corners
+ *
+ * Navmesh answers are cached per world cell and kept as the grid scrolls with the player, so a rebuild only asks about cells it hasn't
+ * seen before. Rebuilds are spread over frames within BuildBudgetMs, and the old field keeps steering enemies until the new one is done
+ */
+UCLASS()
+class MYPROJECT_API UEnemyFlowFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyFlowFieldSubsystem();
+
+	/** Size of one flow field cell */
+	float CellSize;
+
+	/** Number of cells from the centre to the edge of the field, so the field is (2 * HalfExtent + 1) cells across */
+	int32 HalfExtent;
+
+	/** The goal has to move this far before we bother rebuilding the field */
+	float RebuildDistance;
+
+	/** Neighbouring cells more than this far apart in height aren't connected (ledges, walls) */
+	float MaxStepHeight;
+
+	/** Most game thread time a rebuild gets per frame. It always makes some progress, however small this is */
+	float BuildBudgetMs;
+
+	/** Cached cells get projected again if the goal has moved up or down more than this since, there may be a different floor closer now */
+	float ReprojectHeight;
+
+	/**
+	 * Starts a rebuild if the goal has moved far enough since the last one, and carries on with any rebuild in progress
+	 * Call once a frame, and only while something is actually chasing the goal
+	 */
+	void UpdateGoal(const FVector& GoalLocation);
+
+	/**
+	* Which way to walk from Location to get to the goal
+	* GoalLocation is where the goal is now. The field may have been built a little way from there, so it's what we head for once we're in its cell
+	* Returns false if Location is outside the field or can't reach the goal through it, then the caller should fall back on a normal MoveTo
+	*/
+	bool SampleDirection(const FVector& Location, const FVector& GoalLocation, FVector& OutDirection) const;
+
+	FORCEINLINE bool HasField() const { return bHasField; }
+
+	FORCEINLINE bool IsBuilding() const { return bBuilding; }
+
+private:
+	/** What the navmesh told us about one world cell */
+	struct FFlowFieldCell
+	{
+		FIntPoint Coord = FIntPoint(MAX_int32, MAX_int32);
+		FVector NavLocation = FVector::ZeroVector;
+		float QueryZ = 0.f; // Height we projected from
+		bool bWalkable = false;
+
+		// One bit per neighbour, same order as the offset tables in the .cpp
+		uint8 LinksKnown = 0;
+		uint8 LinksOpen = 0;
+	};
+
+	struct FOpenCell
+	{
+		int32 Index;
+		float Distance;
+		bool operator<(const FOpenCell& Other) const { return Distance < Other.Distance; }
+	};
+
+	void StartBuild(const FVector& GoalLocation);
+
+	/** Runs the build until it finishes or the frame's budget is gone. Swaps the new field in once it's done */
+	void ContinueBuild();
+
+	/** The cached cell for Coord, asking the navmesh about it first if we don't have it */
+	FFlowFieldCell& EnsureProjected(const FIntPoint& Coord, const class ANavigationData* NavData);
+
+	/** Whether you can walk from Cell to its neighbour in Direction. Raycasts the navmesh the first time and caches the answer both ways */
+	bool IsLinked(const FIntPoint& Cell, int32 Direction, const ANavigationData* NavData);
+
+	FORCEINLINE FIntPoint GetWorldCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	/** Cache slot for a world cell. The cache wraps around, so cells that scroll off one side are reused for cells coming in on the other */
+	FORCEINLINE int32 GetCacheSlot(const FIntPoint& Coord) const
+	{
+		const int32 Width = GetGridWidth();
+		return ((Coord.Y % Width + Width) % Width) * Width + (Coord.X % Width + Width) % Width;
+	}
+
+	/** Cell index for a world location in the finished field, INDEX_NONE if it's outside it */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	FORCEINLINE int32 GetGridWidth() const { return HalfExtent * 2 + 1; }
+
+	TArray<FFlowFieldCell> CellCache;
+
+	// The finished field enemies steer by
+	FVector FieldOrigin; // World location of cell (0, 0)
+	FVector Goal;
+	TArray<float> Distances; // Distance to the goal through the field, MAX_flt if unreachable
+	TArray<uint8> NextHops; // Which neighbour to walk to next, NoNextHop for the goal's cell and anywhere unreachable
+	bool bHasField;
+
+	// The one being built
+	bool bBuilding;
+	FVector BuildGoal;
+	FIntPoint BuildMinCell;
+	TArray<float> BuildDistances;
+	TArray<uint8> BuildNextHops;
+	TArray<FOpenCell> BuildOpen;
+
+	static const uint8 NoNextHop = 0xFF;
+};
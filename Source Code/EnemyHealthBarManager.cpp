@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyHealthBarManager.h"
+#include "MyProject.h"
+#include "MainPlayerController.h"
+#include "EnemyHealthBarWidget.h"
+#include "Blueprint/UserWidget.h"
+#include "Enemy.h"
+#include "Main.h"
+#include "EnemySpatialSubsystem.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "SceneView.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Health Bars Update"), STAT_EnemyHealthBarsUpdate, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Health Bars Shown"), STAT_EnemyHealthBarsShown, STATGROUP_MyProject);
+
+UEnemyHealthBarManager::UEnemyHealthBarManager()
+{
+	Range = 2000.f;
+	BarSize = FVector2D(150.f, 25.f);
+	ScreenOffset = 85.f;
+	OcclusionCheckInterval = 0.2f;
+	Controller = nullptr;
+}
+
+void UEnemyHealthBarManager::Initialize(AMainPlayerController* InController, TSubclassOf<UUserWidget> WidgetClass, int32 MaxBars)
+{
+	Controller = InController;
+	if (Controller == nullptr || WidgetClass == nullptr) return;
+
+	for (int32 i = 0; i < MaxBars; i++)
+	{
+		UUserWidget* Widget = CreateWidget<UUserWidget>(Controller, WidgetClass);
+		if (Widget == nullptr) continue;
+
+		Widget->AddToViewport();
+		Widget->SetVisibility(ESlateVisibility::Hidden);
+		Widget->SetAlignmentInViewport(FVector2D(0.f, 0.f));
+		Widget->SetDesiredSizeInViewport(BarSize);
+
+		FEnemyHealthBarSlot Slot;
+		Slot.Widget = Widget;
+		Slots.Add(Slot);
+	}
+}
+
+void UEnemyHealthBarManager::GatherTargets(TArray<AEnemy*>& OutTargets) const
+{
+	OutTargets.Reset();
+
+	AMain* Main = Cast<AMain>(Controller->GetPawn());
+	UEnemySpatialSubsystem* Spatial = Controller->GetWorld()->GetSubsystem<UEnemySpatialSubsystem>();
+	if (Main == nullptr || Spatial == nullptr) return;
+
+	// Our own combat target always gets a bar, same as the old single health bar did
+	if (Main->CombatTarget && Main->CombatTarget->Alive())
+	{
+		OutTargets.Add(Main->CombatTarget);
+	}
+
+	// Then whoever else nearby is in a fight, closest first
+	TArray<AEnemy*> Nearby;
+	Spatial->GatherAliveEnemiesInRadius(Main->GetActorLocation(), Range, Nearby);
+	for (AEnemy* Enemy : Nearby)
+	{
+		if (OutTargets.Num() >= Slots.Num()) break;
+		if (Enemy->bHasValidTarget && Enemy != Main->CombatTarget)
+		{
+			OutTargets.Add(Enemy);
+		}
+	}
+}
+
+void UEnemyHealthBarManager::SetSlotShown(FEnemyHealthBarSlot& Slot, bool bShow)
+{
+	if (Slot.bShown == bShow) return;
+
+	Slot.bShown = bShow;
+	Slot.Widget->SetVisibility(bShow ? ESlateVisibility::Visible : ESlateVisibility::Hidden);
+}
+
+void UEnemyHealthBarManager::Update()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyHealthBarsUpdate);
+
+	if (Controller == nullptr || Slots.Num() == 0) return;
+
+	TArray<AEnemy*> Targets;
+	GatherTargets(Targets);
+
+	// Enemies that already have a bar keep it, so bars don't jump between widgets as the order shuffles
+	for (FEnemyHealthBarSlot& Slot : Slots)
+	{
+		AEnemy* Enemy = Slot.Enemy.Get();
+		if (Enemy && Targets.RemoveSingleSwap(Enemy, false) > 0) continue;
+
+		Slot.Enemy = nullptr;
+	}
+	for (FEnemyHealthBarSlot& Slot : Slots)
+	{
+		if (Targets.Num() == 0) break;
+		if (Slot.Enemy.IsValid()) continue;
+
+		Slot.Enemy = Targets.Pop(false);
+		Slot.HealthPercent = -1.f;
+		Slot.NextOcclusionCheck = 0.f;
+
+		UEnemyHealthBarWidget* BarWidget = Cast<UEnemyHealthBarWidget>(Slot.Widget);
+		if (BarWidget)
+		{
+			BarWidget->SetEnemy(Slot.Enemy.Get());
+		}
+	}
+
+	// One view projection matrix for every bar, rather than working it out again for each ProjectWorldLocationToScreen
+	ULocalPlayer* LocalPlayer = Controller->GetLocalPlayer();
+	FSceneViewProjectionData ProjectionData;
+	const bool bHasView = LocalPlayer && LocalPlayer->ViewportClient && LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, eSSP_FULL, ProjectionData);
+	const FMatrix ViewProjection = bHasView ? ProjectionData.ComputeViewProjectionMatrix() : FMatrix::Identity;
+	const FIntRect ViewRect = ProjectionData.GetConstrainedViewRect();
+
+	UWorld* World = Controller->GetWorld();
+	const float Now = World->GetTimeSeconds();
+	int32 NumShown = 0;
+
+	for (FEnemyHealthBarSlot& Slot : Slots)
+	{
+		AEnemy* Enemy = Slot.Enemy.Get();
+		if (Enemy == nullptr || !bHasView)
+		{
+			SetSlotShown(Slot, false);
+			continue;
+		}
+
+		const FVector EnemyLocation = Enemy->GetActorLocation();
+
+		// Behind the camera, or off the edge of the screen
+		FVector2D ScreenPosition;
+		if (!FSceneView::ProjectWorldToScreen(EnemyLocation, ViewRect, ViewProjection, ScreenPosition) || !ViewRect.Contains(FIntPoint(ScreenPosition.X, ScreenPosition.Y)))
+		{
+			SetSlotShown(Slot, false);
+			continue;
+		}
+
+		if (Now >= Slot.NextOcclusionCheck)
+		{
+			FCollisionQueryParams Params(SCENE_QUERY_STAT(EnemyHealthBarOcclusion), false);
+			Params.AddIgnoredActor(Enemy);
+			Params.AddIgnoredActor(Controller->GetPawn());
+
+			FHitResult Hit;
+			Slot.bOccluded = World->LineTraceSingleByChannel(Hit, ProjectionData.ViewOrigin, EnemyLocation, ECC_Visibility, Params);
+			Slot.NextOcclusionCheck = Now + OcclusionCheckInterval;
+		}
+		if (Slot.bOccluded)
+		{
+			SetSlotShown(Slot, false);
+			continue;
+		}
+
+		ScreenPosition.Y -= ScreenOffset;
+		if (!ScreenPosition.Equals(Slot.Position, 0.5f))
+		{
+			Slot.Position = ScreenPosition;
+			Slot.Widget->SetPositionInViewport(ScreenPosition);
+		}
+
+		const float HealthPercent = Enemy->MaxHealth > 0.f ? Enemy->Health / Enemy->MaxHealth : 0.f;
+		if (HealthPercent != Slot.HealthPercent)
+		{
+			Slot.HealthPercent = HealthPercent;
+			UEnemyHealthBarWidget* BarWidget = Cast<UEnemyHealthBarWidget>(Slot.Widget);
+			if (BarWidget)
+			{
+				BarWidget->SetHealthPercent(HealthPercent);
+			}
+		}
+
+		SetSlotShown(Slot, true);
+		NumShown++;
+	}
+
+	SET_DWORD_STAT(STAT_EnemyHealthBarsShown, NumShown);
+}
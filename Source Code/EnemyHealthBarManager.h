@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "EnemyHealthBarManager.generated.h"
+
+USTRUCT()
+struct FEnemyHealthBarSlot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class UUserWidget* Widget = nullptr;
+
+	TWeakObjectPtr<class AEnemy> Enemy;
+
+	// What we last told the widget, so we only touch it when something changes
+	bool bShown = false;
+	FVector2D Position = FVector2D(-1.f, -1.f);
+	float HealthPercent = -1.f;
+
+	// Line of sight is only checked every so often, it doesn't change much between frames
+	bool bOccluded = false;
+	float NextOcclusionCheck = 0.f;
+};
+
+/**
+ * Shows health bars over up to MaxBars nearby enemies that are in a fight, using a fixed set of widgets made up front
+ * Every frame it picks the targets, projects them all with one view projection, and hides the ones that are off screen or behind a wall
+ * Widgets only get SetVisibility/SetPositionInViewport calls when their state actually changes
+ */
+UCLASS()
+class MYPROJECT_API UEnemyHealthBarManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyHealthBarManager();
+
+	/** Creates the widget pool. Every widget goes in the viewport hidden and stays there */
+	void Initialize(class AMainPlayerController* InController, TSubclassOf<UUserWidget> WidgetClass, int32 MaxBars);
+
+	/** Picks targets, projects and culls them, and updates the widgets. Called from the controller's Tick */
+	void Update();
+
+	/** Enemies further than this from the player never get a bar */
+	float Range;
+
+	/** Bar size and how far above the enemy's location it sits, in screen pixels */
+	FVector2D BarSize;
+	float ScreenOffset;
+
+	/** Seconds between line of sight checks for each bar */
+	float OcclusionCheckInterval;
+
+private:
+	UPROPERTY()
+	AMainPlayerController* Controller;
+
+	UPROPERTY()
+	TArray<FEnemyHealthBarSlot> Slots;
+
+	void GatherTargets(TArray<AEnemy*>& OutTargets) const;
+	void SetSlotShown(FEnemyHealthBarSlot& Slot, bool bShow);
+};
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "EnemyHealthBarWidget.generated.h"
+
+/**
+ * Native base for the enemy health bar. The health bar manager reuses these between enemies, so the bar shows whatever Enemy it was
+ * last given rather than the player's combat target
+ */
+UCLASS()
+class MYPROJECT_API UEnemyHealthBarWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UProgressBar* HealthBar;
+
+	/** The enemy this bar is showing right now */
+	UPROPERTY(BlueprintReadOnly, Category = "HUD")
+	class AEnemy* Enemy;
+
+	void SetEnemy(AEnemy* InEnemy) { Enemy = InEnemy; }
+
+	void SetHealthPercent(float Percent);
+};
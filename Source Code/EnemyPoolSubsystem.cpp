@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyPoolSubsystem.h"
+#include "MyProject.h"
+#include "Enemy.h"
+#include "AIController.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Pool Acquire"), STAT_EnemyPoolAcquire, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Pool Hits"), STAT_EnemyPoolHits, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Pool Misses"), STAT_EnemyPoolMisses, STATGROUP_MyProject);
+
+AEnemy* UEnemyPoolSubsystem::SpawnPooledEnemy(TSubclassOf<AEnemy> EnemyClass, const FVector& Location, const FRotator& Rotation)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	AEnemy* Enemy = GetWorld()->SpawnActor<AEnemy>(EnemyClass, Location, Rotation, SpawnParams);
+	if (Enemy)
+	{
+		// Same as ASpawnVolume does for any enemy it spawns, but we only ever pay for this once per pooled enemy
+		Enemy->SpawnDefaultController();
+		Enemy->AIController = Cast<AAIController>(Enemy->GetController());
+		Enemy->bPooled = true;
+	}
+	return Enemy;
+}
+
+void UEnemyPoolSubsystem::Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count, const FVector& Location)
+{
+	if (EnemyClass == nullptr) return;
+
+	FEnemyPool& Pool = Pools.FindOrAdd(EnemyClass);
+	while (Pool.Inactive.Num() < Count)
+	{
+		AEnemy* Enemy = SpawnPooledEnemy(EnemyClass, Location, FRotator::ZeroRotator);
+		if (Enemy == nullptr) break;
+
+		Enemy->SetPoolActive(false);
+		Pool.Inactive.Add(Enemy);
+	}
+}
+
+AEnemy* UEnemyPoolSubsystem::Acquire(TSubclassOf<AEnemy> EnemyClass, const FVector& Location, const FRotator& Rotation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPoolAcquire);
+
+	if (EnemyClass == nullptr) return nullptr;
+
+	FEnemyPool& Pool = Pools.FindOrAdd(EnemyClass);
+	while (Pool.Inactive.Num() > 0)
+	{
+		AEnemy* Enemy = Pool.Inactive.Pop(false);
+		if (Enemy == nullptr || Enemy->IsPendingKill()) continue; // Something else destroyed it while it was pooled
+
+		INC_DWORD_STAT(STAT_EnemyPoolHits);
+
+		Enemy->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		Enemy->ResetForReuse();
+		Enemy->SetPoolActive(true);
+		return Enemy;
+	}
+
+	// Pool ran dry, so this one costs a full spawn. It'll join the pool when it dies
+	INC_DWORD_STAT(STAT_EnemyPoolMisses);
+	return SpawnPooledEnemy(EnemyClass, Location, Rotation);
+}
+
+void UEnemyPoolSubsystem::Release(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) return;
+
+	Enemy->SetPoolActive(false);
+	Pools.FindOrAdd(Enemy->GetClass()).Inactive.AddUnique(Enemy);
+
+	OnEnemyReleased.Broadcast(Enemy);
+}
+
+int32 UEnemyPoolSubsystem::GetNumInactive(TSubclassOf<AEnemy> EnemyClass) const
+{
+	const FEnemyPool* Pool = Pools.Find(EnemyClass);
+	return Pool ? Pool->Inactive.Num() : 0;
+}
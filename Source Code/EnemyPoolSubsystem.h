@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemyPoolSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnemyReleased, class AEnemy*);
+
+USTRUCT()
+struct FEnemyPool
+{
+	GENERATED_BODY()
+
+	/** Enemies of one class that are hidden and waiting to be spawned again */
+	UPROPERTY()
+	TArray<class AEnemy*> Inactive;
+};
+
+/**
+ * Keeps dead enemies around (hidden, with their AIController) so we can spawn them again without building a whole new actor
+ * Shared by every spawn volume in the world, one pool per enemy class
+ */
+UCLASS()
+class MYPROJECT_API UEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Makes sure at least Count inactive enemies of this class are waiting in the pool */
+	void Prewarm(TSubclassOf<AEnemy> EnemyClass, int32 Count, const FVector& Location);
+
+	/** Takes an enemy out of the pool and puts it at Location, or spawns a new one if the pool is empty */
+	AEnemy* Acquire(TSubclassOf<AEnemy> EnemyClass, const FVector& Location, const FRotator& Rotation);
+
+	/** Hands an enemy back. It's hidden and reset rather than destroyed */
+	void Release(AEnemy* Enemy);
+
+	/** Fires for every enemy handed back, so whoever spawned it knows it's gone without having to poll */
+	FOnEnemyReleased OnEnemyReleased;
+
+	int32 GetNumInactive(TSubclassOf<AEnemy> EnemyClass) const;
+
+private:
+	/** Spawns a brand new pooled enemy with its own AIController */
+	AEnemy* SpawnPooledEnemy(TSubclassOf<AEnemy> EnemyClass, const FVector& Location, const FRotator& Rotation);
+
+	UPROPERTY()
+	TMap<UClass*, FEnemyPool> Pools;
+};
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "EnemyPoolSubsystem.h"
+#include "Enemy.h"
+#include "AIController.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Benchmark for spawning a wave: 50 enemies from a prewarmed pool against spawning them fresh the way ASpawnVolume does without pooling
+// Each side spawns the wave, then gets rid of it (released back to the pool, or destroyed), a few times over. The spawn is what lands
+// in a single frame in game, so that's reported against a 60Hz frame. The world never begins play, so a fresh spawn here doesn't pay
+// for BeginPlay the way it would in game; the real gap is wider than this shows
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnemyPoolWaveBenchmark, "MyProject.Performance.EnemyWaveSpawn",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FEnemyPoolWaveBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 WaveSize = 50;
+	const int32 NumWaves = 10;
+	const float ArenaHalfSize = 2000.f;
+	const double FrameBudgetMs = 1000.0 / 60.0;
+
+	for (const bool bUsePooling : { false, true })
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		UEnemyPoolSubsystem* Pool = World->GetSubsystem<UEnemyPoolSubsystem>();
+		if (!TestNotNull(TEXT("Pool subsystem"), Pool))
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+			return false;
+		}
+
+		// Same as a spawn volume would do when the level loads, before the first wave is due
+		if (bUsePooling)
+		{
+			Pool->Prewarm(AEnemy::StaticClass(), WaveSize, FVector::ZeroVector);
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		// Same seed every run so the numbers are comparable between runs
+		FRandomStream Random(WaveSize);
+		double WorstWaveMs = 0.0;
+		double TotalWaveMs = 0.0;
+		int32 NumSpawned = 0;
+
+		for (int32 Wave = 0; Wave < NumWaves; Wave++)
+		{
+			TArray<FVector> Locations;
+			for (int32 i = 0; i < WaveSize; i++)
+			{
+				Locations.Add(FVector(Random.FRandRange(-ArenaHalfSize, ArenaHalfSize), Random.FRandRange(-ArenaHalfSize, ArenaHalfSize), 0.f));
+			}
+
+			TArray<AEnemy*> WaveEnemies;
+			WaveEnemies.Reserve(WaveSize);
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (const FVector& Location : Locations)
+			{
+				AEnemy* Enemy = nullptr;
+				if (bUsePooling)
+				{
+					Enemy = Pool->Acquire(AEnemy::StaticClass(), Location, FRotator::ZeroRotator);
+				}
+				else
+				{
+					// What ASpawnVolume::SpawnOurActor does with pooling off
+					Enemy = World->SpawnActor<AEnemy>(Location, FRotator::ZeroRotator, SpawnParams);
+					if (Enemy)
+					{
+						Enemy->SpawnDefaultController();
+						Enemy->AIController = Cast<AAIController>(Enemy->GetController());
+					}
+				}
+				if (Enemy)
+				{
+					WaveEnemies.Add(Enemy);
+				}
+			}
+			const double WaveMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			WorstWaveMs = FMath::Max(WorstWaveMs, WaveMs);
+			TotalWaveMs += WaveMs;
+			NumSpawned += WaveEnemies.Num();
+
+			// Clear the wave out before the next one, the way killing it would
+			for (AEnemy* Enemy : WaveEnemies)
+			{
+				if (bUsePooling)
+				{
+					Pool->Release(Enemy);
+				}
+				else
+				{
+					if (Enemy->GetController())
+					{
+						Enemy->GetController()->Destroy();
+					}
+					Enemy->Destroy();
+				}
+			}
+		}
+
+		const double AverageWaveMs = TotalWaveMs / NumWaves;
+		AddInfo(FString::Printf(TEXT("%s: %d enemy wave %.3f ms average (%.0f%% of a 60Hz frame), %.3f ms worst, over %d waves"),
+			bUsePooling ? TEXT("Pooled  ") : TEXT("Unpooled"), WaveSize, AverageWaveMs, AverageWaveMs * 100.0 / FrameBudgetMs, WorstWaveMs, NumWaves));
+
+		TestEqual(FString::Printf(TEXT("Every enemy spawned (%s)"), bUsePooling ? TEXT("pooled") : TEXT("unpooled")), NumSpawned, WaveSize * NumWaves);
+
+		// Prewarmed to the wave size, so every wave should have come straight out of the pool without spawning anything new
+		if (bUsePooling)
+		{
+			TestEqual(TEXT("Pool back to full after the last wave"), Pool->GetNumInactive(AEnemy::StaticClass()), WaveSize);
+		}
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
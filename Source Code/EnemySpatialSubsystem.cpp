@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemySpatialSubsystem.h"
+#include "MyProject.h"
+#include "Enemy.h"
+#include "Components/SphereComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Spatial Rebuild"), STAT_EnemySpatialRebuild, STATGROUP_MyProject);
+DECLARE_CYCLE_STAT(TEXT("Enemy Spatial Query"), STAT_EnemySpatialQuery, STATGROUP_MyProject);
+
+UEnemySpatialSubsystem::UEnemySpatialSubsystem()
+{
+	CellSize = 600.f; // Matches the default AggroSphere radius, so most queries only look at a 3x3 block of cells
+	MaxRadius = 0.f;
+	LastBuildFrame = MAX_uint64;
+}
+
+void UEnemySpatialSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy)
+	{
+		Enemies.AddUnique(Enemy);
+		MarkStale(); // Indices changed, so the grid has to be rebuilt before the next query
+	}
+}
+
+void UEnemySpatialSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (Enemies.RemoveSwap(Enemy) > 0)
+	{
+		MarkStale();
+	}
+}
+
+FIntPoint UEnemySpatialSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UEnemySpatialSubsystem::RebuildIfStale()
+{
+	if (LastBuildFrame == GFrameCounter) return; // Enemies only move once per frame, so one rebuild covers every query this frame
+
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialRebuild);
+
+	LastBuildFrame = GFrameCounter;
+	MaxRadius = 0.f;
+
+	// Empty the cells but keep their memory around, the same cells tend to get used frame after frame
+	for (auto& Cell : Grid)
+	{
+		Cell.Value.Reset();
+	}
+
+	Locations.SetNumUninitialized(Enemies.Num(), false);
+	Radii.SetNumUninitialized(Enemies.Num(), false);
+
+	for (int32 i = 0; i < Enemies.Num(); i++)
+	{
+		AEnemy* Enemy = Enemies[i];
+		if (Enemy == nullptr || !Enemy->Alive())
+		{
+			// Dead enemies stay registered until they despawn, but they never show up in a query
+			Radii[i] = -1.f;
+			continue;
+		}
+
+		Locations[i] = Enemy->GetActorLocation();
+		Radii[i] = Enemy->AggroSphere ? Enemy->AggroSphere->GetScaledSphereRadius() : 0.f;
+		MaxRadius = FMath::Max(MaxRadius, Radii[i]);
+
+		Grid.FindOrAdd(GetCell(Locations[i])).Add(i);
+	}
+}
+
+AEnemy* UEnemySpatialSubsystem::FindNearestAliveEnemy(const FVector& Origin, float ExtraRadius, float ExtraHalfHeight, TSubclassOf<AEnemy> Filter)
+{
+	RebuildIfStale();
+
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialQuery);
+
+	// The capsule is a vertical segment of this half length with ExtraRadius around it
+	const float SegmentHalfLength = FMath::Max(ExtraHalfHeight - ExtraRadius, 0.f);
+
+	// Only the cells that could possibly hold an enemy whose aggro sphere reaches us. Cells are X/Y only, so every height is covered
+	const float SearchRadius = MaxRadius + ExtraRadius;
+	const FIntPoint MinCell = GetCell(Origin - FVector(SearchRadius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(SearchRadius));
+
+	AEnemy* ClosestEnemy = nullptr;
+	float MinDistanceSquared = MAX_flt;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<int32>* Cell = Grid.Find(FIntPoint(X, Y));
+			if (Cell == nullptr) continue;
+
+			for (int32 Index : *Cell)
+			{
+				// Compare squared distances, no need for the square root just to find the smallest one
+				const FVector Offset = Locations[Index] - Origin;
+				const float DistanceSquared = Offset.SizeSquared();
+				if (DistanceSquared >= MinDistanceSquared) continue;
+
+				// Sphere against capsule: the distance from the sphere's centre to the nearest point on the capsule's segment
+				const float SegmentDistanceSquared = Offset.SizeSquared2D() + FMath::Square(FMath::Max(FMath::Abs(Offset.Z) - SegmentHalfLength, 0.f));
+				if (SegmentDistanceSquared > FMath::Square(Radii[Index] + ExtraRadius)) continue;
+
+				AEnemy* Enemy = Enemies[Index];
+				if (Enemy && Enemy->Alive() && (Filter == nullptr || Enemy->IsA(Filter)))
+				{
+					MinDistanceSquared = DistanceSquared;
+					ClosestEnemy = Enemy;
+				}
+			}
+		}
+	}
+
+	return ClosestEnemy;
+}
+
+void UEnemySpatialSubsystem::GatherAliveEnemiesInRadius(const FVector& Origin, float Radius, TArray<AEnemy*>& OutEnemies)
+{
+	RebuildIfStale();
+
+	SCOPE_CYCLE_COUNTER(STAT_EnemySpatialQuery);
+
+	OutEnemies.Reset();
+
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius));
+	const float RadiusSquared = FMath::Square(Radius);
+
+	TArray<TPair<float, AEnemy*>, TInlineAllocator<32>> Found;
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<int32>* Cell = Grid.Find(FIntPoint(X, Y));
+			if (Cell == nullptr) continue;
+
+			for (int32 Index : *Cell)
+			{
+				const float DistanceSquared = FVector::DistSquared(Locations[Index], Origin);
+				if (DistanceSquared > RadiusSquared) continue;
+
+				AEnemy* Enemy = Enemies[Index];
+				if (Enemy && Enemy->Alive())
+				{
+					Found.Emplace(DistanceSquared, Enemy);
+				}
+			}
+		}
+	}
+
+	Found.Sort([](const TPair<float, AEnemy*>& A, const TPair<float, AEnemy*>& B) { return A.Key < B.Key; });
+	for (const TPair<float, AEnemy*>& Entry : Found)
+	{
+		OutEnemies.Add(Entry.Value);
+	}
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemySpatialSubsystem.generated.h"
+
+/**
+ * Keeps every live AEnemy in a uniform spatial hash so we can answer "who is the closest enemy near this point" 
+ * without gathering overlaps and square rooting every distance
+ */
+UCLASS()
+class MYPROJECT_API UEnemySpatialSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UEnemySpatialSubsystem();
+
+	/** Size of one grid cell on the X/Y plane. Should be roughly the size of an enemy aggro sphere */
+	float CellSize;
+
+	// Enemies register themselves in BeginPlay and unregister in EndPlay
+	void RegisterEnemy(class AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	/** 
+	* Finds the closest alive enemy whose aggro sphere reaches a capsule at Origin, without touching the physics scene
+	* Only the aggro sphere counts, so this is close to what GetOverlappingActors hands back but not always the same:
+	* that also counts the enemy's other components, and anything with its collision turned off in the middle of a fight
+	* @param ExtraRadius Radius of the querying actor's capsule
+	* @param ExtraHalfHeight Half height of the querying actor's capsule. 0 treats it as a sphere
+	* @param Filter Optional class filter, same as the one passed to GetOverlappingActors
+	*/
+	AEnemy* FindNearestAliveEnemy(const FVector& Origin, float ExtraRadius, float ExtraHalfHeight = 0.f, TSubclassOf<AEnemy> Filter = nullptr);
+
+	/** Every alive enemy within Radius of Origin (ignoring aggro spheres), closest first */
+	void GatherAliveEnemiesInRadius(const FVector& Origin, float Radius, TArray<AEnemy*>& OutEnemies);
+
+	FORCEINLINE int32 GetNumEnemies() const { return Enemies.Num(); }
+
+	/** Makes the next query rebuild the grid even if one already ran this frame. For when enemies were moved outside their own tick */
+	FORCEINLINE void MarkStale() { LastBuildFrame = MAX_uint64; }
+
+private:
+	/** Re-bins every enemy by its current location. Only runs once per frame, and only if somebody actually queries */
+	void RebuildIfStale();
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	// Packed arrays, one entry per registered enemy
+	UPROPERTY()
+	TArray<AEnemy*> Enemies;
+
+	TArray<FVector> Locations;
+	TArray<float> Radii; // Scaled aggro sphere radius for each enemy
+
+	// Cell -> indices into the arrays above
+	TMap<FIntPoint, TArray<int32>> Grid;
+
+	// Largest aggro radius we've binned, used to work out how many cells a query has to look at
+	float MaxRadius;
+
+	uint64 LastBuildFrame;
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "EnemySpatialSubsystem.h"
+#include "Enemy.h"
+#include "Main.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Components/CapsuleComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Benchmark for the combat target search: the spatial hash against the old GetOverlappingActors path, at 10, 100 and 1000 enemies
+// Enemies are scattered over the same area each time so the number the player overlaps grows with the count, like a busier level would
+// The world never begins play, so nothing ticks and the only cost measured is the search itself. The spatial side is charged a
+// grid rebuild for every query, which is what it pays in game when the player looks for a new target once a frame
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnemySpatialCombatTargetBenchmark, "MyProject.Performance.CombatTargetSearch",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FEnemySpatialCombatTargetBenchmark::RunTest(const FString& Parameters)
+{
+	const float ArenaHalfSize = 10000.f;
+	const int32 NumQueries = 1000;
+
+	for (const int32 NumEnemies : { 10, 100, 1000 })
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AMain* Main = World->SpawnActor<AMain>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+		UEnemySpatialSubsystem* SpatialSubsystem = World->GetSubsystem<UEnemySpatialSubsystem>();
+		if (!TestNotNull(TEXT("Main"), Main) || !TestNotNull(TEXT("Spatial subsystem"), SpatialSubsystem))
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+			return false;
+		}
+
+		// Same seed every run so the numbers are comparable between runs
+		FRandomStream Random(NumEnemies);
+		for (int32 i = 0; i < NumEnemies; i++)
+		{
+			const FVector Location(Random.FRandRange(-ArenaHalfSize, ArenaHalfSize), Random.FRandRange(-ArenaHalfSize, ArenaHalfSize), 0.f);
+			AEnemy* Enemy = World->SpawnActor<AEnemy>(Location, FRotator::ZeroRotator, SpawnParams);
+			if (Enemy)
+			{
+				// BeginPlay would do this, but it never runs in a world that hasn't begun play
+				SpatialSubsystem->RegisterEnemy(Enemy);
+			}
+		}
+
+		// Fill in the overlap lists GetOverlappingActors reads from
+		Main->UpdateOverlaps(false);
+
+		const FVector Origin = Main->GetActorLocation();
+		const float CapsuleRadius = Main->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		const float CapsuleHalfHeight = Main->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+		// Make every query pay for a rebuild, like it would once a frame in game
+		AEnemy* SpatialResult = nullptr;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			SpatialSubsystem->MarkStale();
+			SpatialResult = SpatialSubsystem->FindNearestAliveEnemy(Origin, CapsuleRadius, CapsuleHalfHeight, Main->EnemyFilter);
+		}
+		const double SpatialSeconds = FPlatformTime::Seconds() - StartTime;
+
+		AEnemy* OverlapResult = nullptr;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			OverlapResult = Main->FindClosestOverlappingEnemy();
+		}
+		const double OverlapSeconds = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("%4d enemies: spatial hash %.2f us/query, GetOverlappingActors %.2f us/query"),
+			NumEnemies, SpatialSeconds * 1000000.0 / NumQueries, OverlapSeconds * 1000000.0 / NumQueries));
+
+		// Both are meant to find the same enemy, otherwise the comparison doesn't mean much
+		TestTrue(FString::Printf(TEXT("Same target at %d enemies"), NumEnemies), SpatialResult == OverlapResult);
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -19,6 +19,8 @@ void AExplosive::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor
     // So to do that we'll call Super
     Super::OnOverlapBegin(OverlappedComponent, OtherActor, OtherComp, OtherBodyIndex, bFromSweep, SweepResult);
 
+    if (bInPool) return; // Already consumed this frame and waiting in the item pool
+
     // Damage the player when the player overlaps with the Explosive
     if (OtherActor) 
     {
@@ -47,7 +49,7 @@ void AExplosive::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor
             // Instead of calling DecrementHealth we can just use UE's own ApplyDamage function
             UGameplayStatics::ApplyDamage(OtherActor, Damage, nullptr, this, DamageTypeClass);
             
-            Destroy();
+            Consume(); // Destroys us, or sends us back to the item pool if we're poolable
         }
     }
 
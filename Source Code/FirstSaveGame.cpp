@@ -11,4 +11,5 @@ UFirstSaveGame::UFirstSaveGame()
     
     CharacterStats.WeaponName = TEXT("");
     CharacterStats.LevelName = TEXT("");
+    CharacterStats.StreamedLevelName = TEXT("");
 }
\ No newline at end of file
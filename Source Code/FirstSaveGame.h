@@ -44,6 +44,16 @@ struct FCharacterStats
 
 	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
 	FString LevelName;
+
+	// The sublevel of LevelName we'd streamed into with a streaming transition, empty if we never did
+	// LevelName alone would put us back in whichever sublevel the map starts with
+	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
+	FString StreamedLevelName;
+
+	// Set when these were handed off on the way out to another map, so Location and Rotation are from the map we left
+	// Loading them puts us on LevelName's PlayerStart instead
+	UPROPERTY(VisibleAnywhere, Category = "SaveGameData")
+	bool bUsePlayerStart = false;
 };
 
 /**
@@ -3,13 +3,16 @@
 
 #include "FloatingPlatform.h"
 #include "Components/StaticMeshComponent.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
+#include "FloatingPlatformSubsystem.h"
 
 // Sets default values
 AFloatingPlatform::AFloatingPlatform()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	// We only tick ourselves without bUseTimedMotion, and even then only while we're actually moving (see ToggleInterping)
 
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
 	RootComponent = Mesh;
@@ -22,6 +25,9 @@ AFloatingPlatform::AFloatingPlatform()
 	InterpSpeed = 4.0f;
 	InterpTime = 1.f;
 
+	bUseTimedMotion = true;
+	DriverIndex = INDEX_NONE;
+
 }
 
 // Called when the game starts or when spawned
@@ -32,10 +38,35 @@ void AFloatingPlatform::BeginPlay()
 	StartPoint = GetActorLocation();
 	EndPoint += StartPoint;
 
-	GetWorldTimerManager().SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
-
 	Distance = (EndPoint - StartPoint).Size(); // Will store the float between the start and endpoints in this variable so we can use it to see how far it's travelled
 
+	// The subsystem moves us along with every other platform, no timers or ticking needed on our end
+	UFloatingPlatformSubsystem* Driver = GetWorld()->GetSubsystem<UFloatingPlatformSubsystem>();
+	if (bUseTimedMotion && Driver)
+	{
+		Driver->RegisterPlatform(this);
+		return;
+	}
+
+	SetActorTickEnabled(bInterping);
+
+	UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+	if (Timers)
+	{
+		Timers->SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+	}
+
+}
+
+void AFloatingPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UFloatingPlatformSubsystem* Driver = GetWorld()->GetSubsystem<UFloatingPlatformSubsystem>();
+	if (Driver)
+	{
+		Driver->UnregisterPlatform(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -54,7 +85,11 @@ void AFloatingPlatform::Tick(float DeltaTime)
 		{
 			ToggleInterping();
 
-			GetWorldTimerManager().SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+			UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+			if (Timers)
+			{
+				Timers->SetTimer(InterpTimer, this, &AFloatingPlatform::ToggleInterping, InterpTime);
+			}
 
 			SwapVectors(StartPoint, EndPoint);
 		}
@@ -64,6 +99,9 @@ void AFloatingPlatform::Tick(float DeltaTime)
 void AFloatingPlatform::ToggleInterping()
 {
 	bInterping = !bInterping;
+
+	// No point ticking while we sit at an end waiting on InterpTimer
+	SetActorTickEnabled(bInterping);
 }
 
 void AFloatingPlatform::SwapVectors(FVector& VecOne, FVector& VecTwo)
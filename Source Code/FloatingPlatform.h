@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GameplayTimingWheel.h"
 #include "FloatingPlatform.generated.h"
 
 UCLASS()
@@ -31,17 +32,29 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
 	float InterpTime;
 
-	FTimerHandle InterpTimer;
+	FGameplayTimerHandle InterpTimer;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
 	bool bInterping;
 
 	float Distance;
 
+	/**
+	 * When true the platform is moved by the UFloatingPlatformSubsystem, and where it is depends only on the world time
+	 * Turn off to go back to stepping VInterpTo in our own Tick
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
+	bool bUseTimedMotion;
+
+	/** Our slot in the floating platform subsystem, INDEX_NONE when it isn't driving us */
+	int32 DriverIndex;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FloatingPlatformSubsystem.h"
+#include "MyProject.h"
+#include "FloatingPlatform.h"
+#include "GameFramework/GameStateBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("Floating Platforms"), STAT_FloatingPlatforms, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Floating Platforms Moving"), STAT_FloatingPlatformsMoving, STATGROUP_MyProject);
+
+FVector FFloatingPlatformMotion::Evaluate(float Time, bool& bOutMoving, float& OutNextMoveTime) const
+{
+	const float CycleTime = GetCycleTime();
+	const float Phase = CycleTime > 0.f ? FMath::Fmod(FMath::Max(Time, 0.f), CycleTime) : 0.f;
+
+	bOutMoving = false;
+	OutNextMoveTime = Time;
+
+	// Waiting at the start
+	if (Phase < WaitTime)
+	{
+		OutNextMoveTime = Time + (WaitTime - Phase);
+		return StartPoint;
+	}
+
+	// Heading out. Same ease out VInterpTo gave us, just worked out from the time instead of stepped every frame
+	const float OutEnd = WaitTime + TravelTime;
+	if (Phase < OutEnd)
+	{
+		bOutMoving = true;
+		const float Alpha = (1.f - FMath::Exp(-InterpSpeed * (Phase - WaitTime))) / EaseScale;
+		return FMath::Lerp(StartPoint, EndPoint, Alpha);
+	}
+
+	// Waiting at the end
+	const float BackStart = OutEnd + WaitTime;
+	if (Phase < BackStart)
+	{
+		OutNextMoveTime = Time + (BackStart - Phase);
+		return EndPoint;
+	}
+
+	// Heading back
+	bOutMoving = true;
+	const float Alpha = (1.f - FMath::Exp(-InterpSpeed * (Phase - BackStart))) / EaseScale;
+	return FMath::Lerp(EndPoint, StartPoint, Alpha);
+}
+
+UFloatingPlatformSubsystem::UFloatingPlatformSubsystem()
+{
+	NextWakeTime = 0.f;
+}
+
+TStatId UFloatingPlatformSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_FloatingPlatforms);
+}
+
+float UFloatingPlatformSubsystem::GetMotionTime() const
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return 0.f;
+
+	AGameStateBase* GameState = World->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+bool UFloatingPlatformSubsystem::IsTickable() const
+{
+	// Everybody's waiting at an end, so there's nothing to move until the first of them sets off again
+	return !IsTemplate() && Platforms.Num() > 0 && GetMotionTime() >= NextWakeTime;
+}
+
+void UFloatingPlatformSubsystem::RegisterPlatform(AFloatingPlatform* Platform)
+{
+	if (Platform == nullptr || Platform->DriverIndex != INDEX_NONE) return;
+
+	FFloatingPlatformMotion Motion;
+	Motion.StartPoint = Platform->StartPoint;
+	Motion.EndPoint = Platform->EndPoint;
+	Motion.WaitTime = FMath::Max(Platform->InterpTime, 0.f);
+	Motion.InterpSpeed = FMath::Max(Platform->InterpSpeed, KINDA_SMALL_NUMBER);
+	Motion.bResting = false;
+
+	// The old Tick stopped once it was within a unit of the end, so a trip takes as long as e^(-Speed * t) needs to shrink the distance down to 1
+	const float Distance = (Motion.EndPoint - Motion.StartPoint).Size();
+	Motion.TravelTime = Distance > 1.f ? FMath::Loge(Distance) / Motion.InterpSpeed : 0.f;
+	Motion.EaseScale = Distance > 1.f ? 1.f - 1.f / Distance : 1.f;
+
+	Platform->DriverIndex = Platforms.Add(Platform);
+	Motions.Add(Motion);
+
+	// Get it into the right spot on the next update
+	NextWakeTime = 0.f;
+}
+
+void UFloatingPlatformSubsystem::UnregisterPlatform(AFloatingPlatform* Platform)
+{
+	if (Platform == nullptr || !Platforms.IsValidIndex(Platform->DriverIndex) || Platforms[Platform->DriverIndex] != Platform) return;
+
+	const int32 Index = Platform->DriverIndex;
+	Platforms.RemoveAtSwap(Index, 1, false);
+	Motions.RemoveAtSwap(Index, 1, false);
+	if (Platforms.IsValidIndex(Index))
+	{
+		Platforms[Index]->DriverIndex = Index;
+	}
+
+	Platform->DriverIndex = INDEX_NONE;
+}
+
+void UFloatingPlatformSubsystem::Tick(float DeltaTime)
+{
+	const float Time = GetMotionTime();
+	float EarliestWake = MAX_flt;
+	int32 NumMoving = 0;
+
+	for (int32 i = 0; i < Platforms.Num(); i++)
+	{
+		AFloatingPlatform* Platform = Platforms[i];
+		if (Platform == nullptr) continue;
+
+		FFloatingPlatformMotion& Motion = Motions[i];
+		bool bMoving = false;
+		float NextMoveTime = Time;
+		const FVector Location = Motion.Evaluate(Time, bMoving, NextMoveTime);
+
+		if (bMoving)
+		{
+			Platform->SetActorLocation(Location);
+			Motion.bResting = false;
+			EarliestWake = Time;
+			NumMoving++;
+		}
+		else
+		{
+			// Snap to the end exactly once, then leave it alone until it's time to go
+			if (!Motion.bResting)
+			{
+				Platform->SetActorLocation(Location);
+				Motion.bResting = true;
+			}
+			EarliestWake = FMath::Min(EarliestWake, NextMoveTime);
+		}
+
+		Platform->bInterping = bMoving;
+	}
+
+	NextWakeTime = EarliestWake;
+	SET_DWORD_STAT(STAT_FloatingPlatformsMoving, NumMoving);
+}
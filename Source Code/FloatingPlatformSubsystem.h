@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FloatingPlatformSubsystem.generated.h"
+
+/** Everything needed to work out where a platform is at any time, worked out once when it registers */
+struct FFloatingPlatformMotion
+{
+	FVector StartPoint;
+	FVector EndPoint;
+
+	float WaitTime;		// How long we sit at each end (InterpTime)
+	float TravelTime;	// How long one trip from end to end takes
+	float InterpSpeed;
+
+	// 1 - e^(-InterpSpeed * TravelTime), so the ease out lands exactly on the end point when the trip is over
+	float EaseScale;
+
+	// True once we've been placed at the end we're waiting at, so we don't keep setting the same location
+	bool bResting;
+
+	float GetCycleTime() const { return 2.f * (WaitTime + TravelTime); }
+
+	/**
+	 * Where the platform is at Time. Wait at the start, travel, wait at the end, travel back, repeat
+	 * @param OutNextMoveTime If we're waiting, when we'll start moving again
+	 */
+	FVector Evaluate(float Time, bool& bOutMoving, float& OutNextMoveTime) const;
+};
+
+/**
+ * Moves every AFloatingPlatform in one update, with each platform's position a pure function of the (server) world time
+ * Only ticks while at least one platform is actually moving
+ */
+UCLASS()
+class MYPROJECT_API UFloatingPlatformSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UFloatingPlatformSubsystem();
+
+	void RegisterPlatform(class AFloatingPlatform* Platform);
+	void UnregisterPlatform(AFloatingPlatform* Platform);
+
+	/** Server world time when we have a game state, so clients and the server put platforms in the same place */
+	float GetMotionTime() const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	// Packed arrays, one entry per platform. Platforms keep their index in DriverIndex
+	UPROPERTY()
+	TArray<AFloatingPlatform*> Platforms;
+
+	TArray<FFloatingPlatformMotion> Motions;
+
+	/** Earliest time a resting platform starts moving again. Nothing to do before then */
+	float NextWakeTime;
+};
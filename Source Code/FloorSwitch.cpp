@@ -4,13 +4,19 @@
 #include "FloorSwitch.h"
 #include "Components/BoxComponent.h"
 #include "Components/StaticMeshComponent.h"
-#include "TimerManager.h"
+#include "GameplayTimerSubsystem.h"
+#include "Curves/CurveFloat.h"
+#include "PrefetchTriggerComponent.h"
+#include "SpawnVolume.h"
+#include "Main.h"
 
 // Sets default values
 AFloorSwitch::AFloorSwitch()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	// We only tick while the door and switch are moving, StartTransition turns it on and Tick turns it off once they get there
 
 	TriggerBox = CreateDefaultSubobject<UBoxComponent>(TEXT("TriggerBox"));
 	RootComponent = TriggerBox;
@@ -35,12 +41,24 @@ AFloorSwitch::AFloorSwitch()
 	Door = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Door"));
 	Door->SetupAttachment(GetRootComponent());
 
+	PrefetchTrigger = CreateDefaultSubobject<UPrefetchTriggerComponent>(TEXT("PrefetchTrigger"));
+	PrefetchTrigger->SetupAttachment(GetRootComponent());
+
 	SwitchTime = 2.f; // This will amount for 2 seconds since we're using it for our time
 	// So our switch will be active for 2 seconds before calling the CloseDoor() function
 	bCharacterOnSwitch = false; // This is the way to combat the problems we have with the timer
 	// By just using the timer, once we step on it it will lower the door, even if we're still on the switch, which we don't want
 	// So we'll use this to check if we're still on the switch while the timers going and make sure to not lower the door unless we're off the switch
 
+	bUseNativeAnimation = false;
+	TransitionTime = 0.75f;
+	DoorRaiseHeight = 450.f;
+	SwitchLowerDepth = 75.f;
+	DoorCurve = nullptr;
+	SwitchCurve = nullptr;
+	TransitionAlpha = 0.f;
+	TransitionDirection = 0.f;
+
 }
 
 // Called when the game starts or when spawned
@@ -57,6 +75,8 @@ void AFloorSwitch::BeginPlay()
 	// These need to be in BeginPlay and not in the constructor because if they happen in the constructor, it may be too early in the game start process for them to work
 	// These may happen before the object they're attached to is constructed, so they won't work
 
+	PrefetchTrigger->OnComponentBeginOverlap.AddDynamic(this, &AFloorSwitch::OnPrefetchOverlapBegin);
+
 	InitialDoorLocation = Door->GetComponentLocation();
 	InitialSwitchLocation = FloorSwitch->GetComponentLocation();
 	
@@ -67,22 +87,56 @@ void AFloorSwitch::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	TransitionAlpha = FMath::Clamp(TransitionAlpha + TransitionDirection * DeltaTime / TransitionTime, 0.f, 1.f);
+	ApplyTransition();
+
+	// All the way open or closed, nothing left to do until somebody steps on or off the switch
+	if ((TransitionDirection > 0.f && TransitionAlpha >= 1.f) || (TransitionDirection < 0.f && TransitionAlpha <= 0.f))
+	{
+		TransitionDirection = 0.f;
+		SetActorTickEnabled(false);
+	}
 }
 
 void AFloorSwitch::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
 {
 	UE_LOG(LogTemp, Warning, TEXT("Overlap Begin"));
 	if (!bCharacterOnSwitch) bCharacterOnSwitch = true;
-	RaiseDoor();
-	LowerFloorSwitch();
+	if (bUseNativeAnimation)
+	{
+		StartTransition(true);
+	}
+	else
+	{
+		RaiseDoor();
+		LowerFloorSwitch();
+	}
 }
 
 void AFloorSwitch::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
 	UE_LOG(LogTemp, Warning, TEXT("Overlap End"));
 	if (bCharacterOnSwitch) bCharacterOnSwitch = false;
-	GetWorldTimerManager().SetTimer(SwitchHandle, this, &AFloorSwitch::CloseDoor, SwitchTime);
-	// GetWorldTimerManager is the function that can actually set timers in game
+	UGameplayTimerSubsystem* Timers = GetWorld()->GetSubsystem<UGameplayTimerSubsystem>();
+	if (Timers)
+	{
+		Timers->SetTimer(SwitchHandle, this, &AFloorSwitch::CloseDoor, SwitchTime);
+		// Our gameplay timer subsystem works just like GetWorldTimerManager, only cheaper to set and clear when there's lots of timers around
+	}
+}
+
+void AFloorSwitch::OnPrefetchOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
+{
+	// The player's close enough that they might be about to open the door, so get the fights behind it ready
+	if (Cast<AMain>(OtherActor) == nullptr) return;
+
+	for (ASpawnVolume* SpawnVolume : GatedSpawnVolumes)
+	{
+		if (SpawnVolume)
+		{
+			SpawnVolume->PrefetchEncounter();
+		}
+	}
 }
 
 void AFloorSwitch::UpdateDoorLocation(float Z)
@@ -106,12 +160,43 @@ void AFloorSwitch::CloseDoor()
 {
 	if (!bCharacterOnSwitch)
 	{
-		LowerDoor();
-		RaiseFloorSwitch();
+		if (bUseNativeAnimation)
+		{
+			StartTransition(false);
+		}
+		else
+		{
+			LowerDoor();
+			RaiseFloorSwitch();
+		}
 	}
 	
 }
 
+void AFloorSwitch::StartTransition(bool bOpen)
+{
+	TransitionDirection = bOpen ? 1.f : -1.f;
+
+	// Already there? Then there's no reason to tick at all
+	if ((bOpen && TransitionAlpha >= 1.f) || (!bOpen && TransitionAlpha <= 0.f))
+	{
+		TransitionDirection = 0.f;
+		return;
+	}
+
+	SetActorTickEnabled(true);
+}
+
+void AFloorSwitch::ApplyTransition()
+{
+	const float DoorAlpha = DoorCurve ? DoorCurve->GetFloatValue(TransitionAlpha) : TransitionAlpha;
+	const float SwitchAlpha = SwitchCurve ? SwitchCurve->GetFloatValue(TransitionAlpha) : TransitionAlpha;
+
+	// Same thing the Blueprint timeline did through these two, just driven from here
+	UpdateDoorLocation(DoorAlpha * DoorRaiseHeight);
+	UpdateFloorSwitchLocation(-SwitchAlpha * SwitchLowerDepth);
+}
+
 // void AFloorSwitch::RaiseDoor()
 // {
 	// Don't need this here since we made it so we can implement it in blueprints!
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "GameplayTimingWheel.h"
 #include "FloorSwitch.generated.h"
 
 UCLASS()
@@ -34,13 +35,55 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "FloorSwitch")
 	FVector InitialSwitchLocation;
 
-	FTimerHandle SwitchHandle; // This will be a timer so the door stays up for however long we set it for
+	FGameplayTimerHandle SwitchHandle; // This will be a timer so the door stays up for however long we set it for
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch")
 	float SwitchTime;
 
 	bool bCharacterOnSwitch;
 
+	/**
+	 * When true the door and switch are animated in C++ from the settings below, and the Blueprint Raise/Lower events aren't called
+	 * Off by default so switches already placed keep their Blueprint timelines. Turn it on per switch to move it over
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch | Animation")
+	bool bUseNativeAnimation;
+
+	/** Seconds to fully open or close */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch | Animation", meta = (ClampMin = "0.01"))
+	float TransitionTime;
+
+	/** How far up the door goes when open */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch | Animation")
+	float DoorRaiseHeight;
+
+	/** How far down the switch gets pushed when stepped on */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch | Animation")
+	float SwitchLowerDepth;
+
+	/** Optional easing for the door, 0 to 1 in time mapped to 0 to 1 of the way open. Linear if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch | Animation")
+	class UCurveFloat* DoorCurve;
+
+	/** Optional easing for the switch, same as DoorCurve */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FloorSwitch | Animation")
+	UCurveFloat* SwitchCurve;
+
+	/** 0 is closed (door down, switch up), 1 is open (door up, switch down) */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "FloorSwitch | Animation")
+	float TransitionAlpha;
+
+	/** Which way we're headed, 1 for opening, -1 for closing, 0 when we're sitting still */
+	float TransitionDirection;
+
+	/** Prefetches what's behind the door as the player gets close to the switch. Fill in its Assets with whatever the gated area needs */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "FloorSwitch | Prefetch")
+	class UPrefetchTriggerComponent* PrefetchTrigger;
+
+	/** Spawn volumes on the other side of the door. Their enemies get prefetched along with the trigger's assets */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "FloorSwitch | Prefetch")
+	TArray<class ASpawnVolume*> GatedSpawnVolumes;
+
 public:	
 	// Sets default values for this actor's properties
 	AFloorSwitch();
@@ -60,6 +103,9 @@ public:
 	UFUNCTION()
 	void OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	UFUNCTION()
+	void OnPrefetchOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
+
 	UFUNCTION(BlueprintImplementableEvent, Category = "FloorSwitch") 
 	void RaiseDoor();
 	// What "BlueprintImplementableEvent" means is that we don't have to provide implementation in C++, we can implement the functionality in blueprints
@@ -82,4 +128,10 @@ public:
 
 	void CloseDoor(); // When our above timer is done it will call this function to close the door
 
+	/** Starts the door and switch moving open or closed from wherever they are now. We only tick until they get there */
+	void StartTransition(bool bOpen);
+
+	/** Puts the door and switch where they should be for TransitionAlpha */
+	void ApplyTransition();
+
 };
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayTimerSubsystem.h"
+#include "MyProject.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay Timers Advance"), STAT_GameplayTimersAdvance, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gameplay Timers Active"), STAT_GameplayTimersActive, STATGROUP_MyProject);
+
+TStatId UGameplayTimerSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_GameplayTimersAdvance);
+}
+
+void UGameplayTimerSubsystem::Tick(float DeltaTime)
+{
+	Wheel.Advance(DeltaTime);
+
+	SET_DWORD_STAT(STAT_GameplayTimersActive, Wheel.GetNumActive());
+}
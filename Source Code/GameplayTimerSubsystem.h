@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayTimingWheel.h"
+#include "GameplayTimerSubsystem.generated.h"
+
+/**
+ * Gameplay timer service for the short per-actor timers we set a lot of (attack cadence, despawns, doors, platforms)
+ * Same idea as GetWorldTimerManager().SetTimer(), but backed by a timing wheel so setting and clearing timers is O(1)
+ */
+UCLASS()
+class MYPROJECT_API UGameplayTimerSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Calls Method on Object once, Delay seconds from now. Replaces whatever InOutHandle was pointing at */
+	template<class UserClass>
+	void SetTimer(FGameplayTimerHandle& InOutHandle, UserClass* Object, typename FSimpleDelegate::TUObjectMethodDelegate<UserClass>::FMethodPtr Method, float Delay)
+	{
+		Wheel.Remove(InOutHandle);
+		InOutHandle = Wheel.Add(Delay, FSimpleDelegate::CreateUObject(Object, Method));
+	}
+
+	FORCEINLINE void ClearTimer(FGameplayTimerHandle& Handle) { Wheel.Remove(Handle); }
+	FORCEINLINE bool IsTimerActive(const FGameplayTimerHandle& Handle) const { return Wheel.IsActive(Handle); }
+	FORCEINLINE float GetTimerRemaining(const FGameplayTimerHandle& Handle) const { return Wheel.GetTimeRemaining(Handle); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !IsTemplate(); }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	FGameplayTimingWheel Wheel;
+};
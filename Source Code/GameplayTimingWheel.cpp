@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayTimingWheel.h"
+
+FGameplayTimingWheel::FGameplayTimingWheel(float InTickInterval)
+{
+	TickInterval = FMath::Max(InTickInterval, KINDA_SMALL_NUMBER);
+	Accumulator = 0.f;
+	CurrentTick = 0;
+	NumActive = 0;
+
+	SlotHeads.Init(INDEX_NONE, NumSlots);
+}
+
+FGameplayTimerHandle FGameplayTimingWheel::Add(float Delay, FSimpleDelegate&& Callback)
+{
+	int32 EntryIndex;
+	if (FreeEntries.Num() > 0)
+	{
+		EntryIndex = FreeEntries.Pop(false);
+	}
+	else
+	{
+		EntryIndex = Entries.AddDefaulted();
+	}
+
+	// Never due on the tick we're already on, that slot has already been fired
+	const uint64 TicksAhead = FMath::Clamp<uint64>((uint64)FMath::CeilToInt((Accumulator + Delay) / TickInterval), 1, MaxTicksAhead);
+
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Callback = MoveTemp(Callback);
+	Entry.ExpireTick = CurrentTick + TicksAhead;
+	Entry.Serial++;
+	Link(EntryIndex);
+	NumActive++;
+
+	FGameplayTimerHandle Handle;
+	Handle.Index = EntryIndex;
+	Handle.Serial = Entry.Serial;
+	return Handle;
+}
+
+void FGameplayTimingWheel::Remove(FGameplayTimerHandle& Handle)
+{
+	if (IsActive(Handle))
+	{
+		Unlink(Handle.Index);
+		Release(Handle.Index);
+	}
+	Handle.Invalidate();
+}
+
+bool FGameplayTimingWheel::IsActive(const FGameplayTimerHandle& Handle) const
+{
+	return Entries.IsValidIndex(Handle.Index) && Entries[Handle.Index].Serial == Handle.Serial && Entries[Handle.Index].Slot != INDEX_NONE;
+}
+
+float FGameplayTimingWheel::GetTimeRemaining(const FGameplayTimerHandle& Handle) const
+{
+	if (!IsActive(Handle)) return -1.f;
+
+	return (Entries[Handle.Index].ExpireTick - CurrentTick) * TickInterval - Accumulator;
+}
+
+void FGameplayTimingWheel::Link(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	const uint64 Delta = Entry.ExpireTick - CurrentTick;
+
+	// Pick the innermost wheel that can hold this timer
+	int32 Slot;
+	if (Delta < InnerSlots)
+	{
+		Slot = Entry.ExpireTick & (InnerSlots - 1);
+	}
+	else
+	{
+		int32 Wheel = 0;
+		while (Wheel < NumOuterWheels - 1 && Delta >= (1ull << (InnerBits + OuterBits * (Wheel + 1))))
+		{
+			Wheel++;
+		}
+		const int32 Shift = InnerBits + OuterBits * Wheel;
+		Slot = InnerSlots + Wheel * OuterSlots + ((Entry.ExpireTick >> Shift) & (OuterSlots - 1));
+	}
+
+	// Push onto the front of the slot's list
+	Entry.Slot = Slot;
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = SlotHeads[Slot];
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = EntryIndex;
+	}
+	SlotHeads[Slot] = EntryIndex;
+}
+
+void FGameplayTimingWheel::Unlink(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		SlotHeads[Entry.Slot] = Entry.Next;
+	}
+
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+void FGameplayTimingWheel::Release(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Slot = INDEX_NONE;
+	Entry.Callback.Unbind();
+	FreeEntries.Add(EntryIndex);
+	NumActive--;
+}
+
+void FGameplayTimingWheel::Cascade(int32 Slot)
+{
+	int32 EntryIndex = SlotHeads[Slot];
+	SlotHeads[Slot] = INDEX_NONE;
+
+	while (EntryIndex != INDEX_NONE)
+	{
+		const int32 Next = Entries[EntryIndex].Next;
+		Link(EntryIndex); // Lands in an inner wheel now that it's closer
+		EntryIndex = Next;
+	}
+}
+
+void FGameplayTimingWheel::StepTick()
+{
+	CurrentTick++;
+
+	// Each time a wheel wraps around, pull the next slot of the wheel outside it inwards
+	for (int32 Wheel = 0; Wheel < NumOuterWheels; Wheel++)
+	{
+		const int32 Shift = InnerBits + OuterBits * Wheel;
+		if ((CurrentTick & ((1ull << Shift) - 1)) != 0) break;
+
+		Cascade(InnerSlots + Wheel * OuterSlots + ((CurrentTick >> Shift) & (OuterSlots - 1)));
+	}
+
+	const int32 Slot = CurrentTick & (InnerSlots - 1);
+	if (SlotHeads[Slot] == INDEX_NONE) return;
+
+	// Take the whole list off the slot before firing anything
+	Firing.Reset();
+	for (int32 EntryIndex = SlotHeads[Slot]; EntryIndex != INDEX_NONE; EntryIndex = Entries[EntryIndex].Next)
+	{
+		Firing.Add(EntryIndex);
+	}
+
+	for (int32 EntryIndex : Firing)
+	{
+		// An earlier callback this tick may have cancelled this one
+		if (Entries[EntryIndex].Slot != Slot) continue;
+
+		Unlink(EntryIndex);
+		FSimpleDelegate Callback = MoveTemp(Entries[EntryIndex].Callback);
+		Release(EntryIndex);
+
+		Callback.ExecuteIfBound(); // Weak UObject binding, so this quietly does nothing if the owner was destroyed
+	}
+}
+
+void FGameplayTimingWheel::Advance(float DeltaTime)
+{
+	Accumulator += DeltaTime;
+	while (Accumulator >= TickInterval)
+	{
+		Accumulator -= TickInterval;
+		StepTick();
+	}
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Handle to a timer in an FGameplayTimingWheel, works like an FTimerHandle */
+struct FGameplayTimerHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0; // Bumped every time the entry is reused, so old handles can't cancel somebody else's timer
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+	FORCEINLINE void Invalidate() { Index = INDEX_NONE; }
+};
+
+/**
+ * Hierarchical timing wheel
+ * Time is cut into fixed ticks. Timers due within the next 256 ticks sit in the slot for their exact tick, timers further out sit in
+ * coarser outer wheels and get moved inwards (cascaded) as their time gets closer. Inserting and cancelling are O(1), and advancing
+ * only touches the slots that are actually due
+ */
+class MYPROJECT_API FGameplayTimingWheel
+{
+public:
+	explicit FGameplayTimingWheel(float InTickInterval = 1.f / 60.f);
+
+	/** Calls Callback once, Delay seconds from now (rounded up to the next tick) */
+	FGameplayTimerHandle Add(float Delay, FSimpleDelegate&& Callback);
+
+	/** Cancels the timer if it's still pending. Safe to call with stale or invalid handles */
+	void Remove(FGameplayTimerHandle& Handle);
+
+	bool IsActive(const FGameplayTimerHandle& Handle) const;
+
+	/** Seconds left before the timer fires, -1 if it isn't active */
+	float GetTimeRemaining(const FGameplayTimerHandle& Handle) const;
+
+	/** Moves time forward, firing everything that comes due */
+	void Advance(float DeltaTime);
+
+	FORCEINLINE int32 GetNumActive() const { return NumActive; }
+
+private:
+	// Inner wheel has 256 slots of one tick each, the three outer wheels have 64 slots that each cover a whole turn of the wheel inside them
+	static constexpr int32 InnerBits = 8;
+	static constexpr int32 OuterBits = 6;
+	static constexpr int32 NumOuterWheels = 3;
+	static constexpr int32 InnerSlots = 1 << InnerBits;
+	static constexpr int32 OuterSlots = 1 << OuterBits;
+	static constexpr int32 NumSlots = InnerSlots + OuterSlots * NumOuterWheels;
+	static constexpr uint64 MaxTicksAhead = (1ull << (InnerBits + OuterBits * NumOuterWheels)) - 1;
+
+	struct FEntry
+	{
+		FSimpleDelegate Callback;
+		uint64 ExpireTick = 0;
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		int32 Slot = INDEX_NONE; // INDEX_NONE when the entry is free
+		uint32 Serial = 0;
+	};
+
+	void Link(int32 EntryIndex);
+	void Unlink(int32 EntryIndex);
+	void Release(int32 EntryIndex);
+
+	/** Moves every timer in an outer slot back into the wheels, now that it's closer */
+	void Cascade(int32 Slot);
+
+	/** Advances one tick, cascading and firing whatever is due */
+	void StepTick();
+
+	float TickInterval;
+	float Accumulator;
+	uint64 CurrentTick;
+	int32 NumActive;
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+	TArray<int32> SlotHeads; // First entry in each slot's list, one list per slot across all the wheels
+
+	// Reused when firing a slot, so callbacks can safely add and remove timers while we go
+	TArray<int32> Firing;
+};
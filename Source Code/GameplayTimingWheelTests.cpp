@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "GameplayTimingWheel.h"
+#include "TimerManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Timers due at each level of the wheel, and right on the edges between them, fire on exactly the tick they were set for
+// One second ticks, so every delay is a whole number of ticks with no rounding to think about
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayTimingWheelCascadeTest, "MyProject.Timers.Cascade",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FGameplayTimingWheelCascadeTest::RunTest(const FString& Parameters)
+{
+	FGameplayTimingWheel Wheel(1.f);
+	uint64 Tick = 0;
+
+	// Inner wheel is 256 ticks, the first outer wheel covers 256 * 64 = 16384 and the second 16384 * 64 = 1048576
+	const uint64 Delays[] = { 1, 2, 255, 256, 257, 300, 511, 512, 16383, 16384, 16385, 20000, 1048575, 1048576, 1048579 };
+	const int32 NumTimers = (int32)UE_ARRAY_COUNT(Delays);
+
+	TArray<uint64> FiredAt;
+	FiredAt.Init(0, NumTimers);
+
+	for (int32 i = 0; i < NumTimers; i++)
+	{
+		Wheel.Add((float)Delays[i], FSimpleDelegate::CreateLambda([&FiredAt, &Tick, i]() { FiredAt[i] = Tick; }));
+	}
+
+	// Part way through, so the timers added now don't line up with a wheel boundary the way the ones above do
+	const uint64 LateStart = 100;
+	const uint64 LateDelays[] = { 200, 16300, 70000 };
+	const int32 NumLateTimers = (int32)UE_ARRAY_COUNT(LateDelays);
+	TArray<uint64> LateFiredAt;
+	LateFiredAt.Init(0, NumLateTimers);
+
+	TestEqual(TEXT("All pending"), Wheel.GetNumActive(), NumTimers);
+
+	const uint64 LastTick = Delays[NumTimers - 1] + 10;
+	while (Tick < LastTick)
+	{
+		if (Tick == LateStart)
+		{
+			for (int32 i = 0; i < NumLateTimers; i++)
+			{
+				Wheel.Add((float)LateDelays[i], FSimpleDelegate::CreateLambda([&LateFiredAt, &Tick, i]() { LateFiredAt[i] = Tick; }));
+			}
+		}
+
+		Tick++;
+		Wheel.Advance(1.f);
+	}
+
+	for (int32 i = 0; i < NumTimers; i++)
+	{
+		TestTrue(FString::Printf(TEXT("Timer set %llu ticks ahead fired on time"), Delays[i]), FiredAt[i] == Delays[i]);
+	}
+	for (int32 i = 0; i < NumLateTimers; i++)
+	{
+		TestTrue(FString::Printf(TEXT("Timer set %llu ticks ahead at tick %llu fired on time"), LateDelays[i], LateStart), LateFiredAt[i] == LateStart + LateDelays[i]);
+	}
+	TestEqual(TEXT("Nothing left"), Wheel.GetNumActive(), 0);
+
+	return true;
+}
+
+// Cancelling, including from a handle whose entry has since been given to another timer
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayTimingWheelCancelTest, "MyProject.Timers.Cancel",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FGameplayTimingWheelCancelTest::RunTest(const FString& Parameters)
+{
+	FGameplayTimingWheel Wheel(1.f);
+	int32 FiredA = 0;
+	int32 FiredB = 0;
+	int32 FiredFar = 0;
+	int32 FiredSameTick = 0;
+
+	// A is cancelled, and B takes over its entry. The copy of A's handle mustn't be able to touch B
+	FGameplayTimerHandle HandleA = Wheel.Add(10.f, FSimpleDelegate::CreateLambda([&FiredA]() { FiredA++; }));
+	FGameplayTimerHandle StaleA = HandleA;
+	Wheel.Remove(HandleA);
+	TestFalse(TEXT("Removing invalidates the handle"), HandleA.IsValid());
+	TestFalse(TEXT("A no longer active"), Wheel.IsActive(StaleA));
+
+	FGameplayTimerHandle HandleB = Wheel.Add(10.f, FSimpleDelegate::CreateLambda([&FiredB]() { FiredB++; }));
+	TestEqual(TEXT("B reuses A's entry"), HandleB.Index, StaleA.Index);
+	TestFalse(TEXT("Stale handle isn't active"), Wheel.IsActive(StaleA));
+	TestEqual(TEXT("Stale handle has no time left"), Wheel.GetTimeRemaining(StaleA), -1.f);
+
+	Wheel.Remove(StaleA);
+	TestTrue(TEXT("Removing through the stale handle leaves B alone"), Wheel.IsActive(HandleB));
+	TestEqual(TEXT("B's time left"), Wheel.GetTimeRemaining(HandleB), 10.f);
+
+	// Cancelled while it's still out in an outer wheel, before it's been cascaded in
+	FGameplayTimerHandle HandleFar = Wheel.Add(1000.f, FSimpleDelegate::CreateLambda([&FiredFar]() { FiredFar++; }));
+
+	// Two due on the same tick that each cancel the other, so whichever fires first stops the other one
+	FGameplayTimerHandle HandleFirst;
+	FGameplayTimerHandle HandleSecond;
+	HandleFirst = Wheel.Add(20.f, FSimpleDelegate::CreateLambda([&Wheel, &HandleSecond, &FiredSameTick]() { FiredSameTick++; Wheel.Remove(HandleSecond); }));
+	HandleSecond = Wheel.Add(20.f, FSimpleDelegate::CreateLambda([&Wheel, &HandleFirst, &FiredSameTick]() { FiredSameTick++; Wheel.Remove(HandleFirst); }));
+
+	Wheel.Advance(5.f);
+	Wheel.Remove(HandleFar);
+	TestFalse(TEXT("Far timer cancelled"), Wheel.IsActive(HandleFar));
+
+	Wheel.Advance(2000.f);
+
+	TestEqual(TEXT("A never fires"), FiredA, 0);
+	TestEqual(TEXT("B fires once"), FiredB, 1);
+	TestEqual(TEXT("Cancelled far timer never fires"), FiredFar, 0);
+	TestEqual(TEXT("Only one of the same tick timers fires"), FiredSameTick, 1);
+	TestFalse(TEXT("B inactive once fired"), Wheel.IsActive(HandleB));
+	TestEqual(TEXT("Nothing left"), Wheel.GetNumActive(), 0);
+
+	return true;
+}
+
+// Benchmark: the timing wheel against a standalone FTimerManager
+// Sets NumTimers timers with random attack-style delays, cancels and re-arms half of them (like enemies re-rolling their attack delay),
+// then runs time forward until everything has fired. FTimerManager only ticks once per engine frame, so rather than stepping both
+// in a loop, a latent command ticks each of them once a frame with a fixed 60Hz delta until they're done
+struct FTimerBenchmarkState
+{
+	static const int32 NumTimers = 10000;
+
+	FGameplayTimingWheel Wheel;
+	FTimerManager TimerManager;
+
+	int32 Frame = 0;
+	int32 NumFrames = 0;
+	int32 WheelFired = 0;
+	int32 TimerManagerFired = 0;
+	double WheelSeconds = 0.0;
+	double TimerManagerSeconds = 0.0;
+};
+
+static const float TimerBenchmarkFrameTime = 1.f / 60.f;
+
+DEFINE_LATENT_AUTOMATION_COMMAND_TWO_PARAMETER(FTimerBenchmarkFrameCommand, TSharedRef<FTimerBenchmarkState>, State, FAutomationTestBase*, Test);
+
+bool FTimerBenchmarkFrameCommand::Update()
+{
+	double StartTime = FPlatformTime::Seconds();
+	State->Wheel.Advance(TimerBenchmarkFrameTime);
+	State->WheelSeconds += FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	State->TimerManager.Tick(TimerBenchmarkFrameTime);
+	State->TimerManagerSeconds += FPlatformTime::Seconds() - StartTime;
+
+	if (++State->Frame < State->NumFrames) return false;
+
+	Test->AddInfo(FString::Printf(TEXT("Timing wheel: %d timers, run %.3f ms over %d frames, fired %d"),
+		FTimerBenchmarkState::NumTimers, State->WheelSeconds * 1000.0, State->NumFrames, State->WheelFired));
+	Test->AddInfo(FString::Printf(TEXT("FTimerManager: %d timers, run %.3f ms over %d frames, fired %d"),
+		FTimerBenchmarkState::NumTimers, State->TimerManagerSeconds * 1000.0, State->NumFrames, State->TimerManagerFired));
+
+	Test->TestEqual(TEXT("Every wheel timer fired"), State->WheelFired, FTimerBenchmarkState::NumTimers);
+	Test->TestEqual(TEXT("Every FTimerManager timer fired"), State->TimerManagerFired, FTimerBenchmarkState::NumTimers);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameplayTimerBenchmark, "MyProject.Performance.Timers",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameplayTimerBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumTimers = FTimerBenchmarkState::NumTimers;
+	const float MaxDelay = 3.5f; // Same as the default AttackMaxTime
+
+	TSharedRef<FTimerBenchmarkState> State = MakeShared<FTimerBenchmarkState>();
+	State->NumFrames = FMath::CeilToInt((MaxDelay + 0.1f) / TimerBenchmarkFrameTime);
+
+	// Same seed every run so the numbers are comparable between runs
+	TArray<float> Delays;
+	Delays.SetNumUninitialized(NumTimers);
+	FRandomStream Random(1234);
+	for (float& Delay : Delays)
+	{
+		Delay = Random.FRandRange(0.5f, MaxDelay);
+	}
+
+	// The state outlives every timer in it, so the callbacks can hold on to it directly
+	FTimerBenchmarkState* RawState = &State.Get();
+
+	{
+		TArray<FGameplayTimerHandle> Handles;
+		Handles.SetNum(NumTimers);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumTimers; i++)
+		{
+			Handles[i] = State->Wheel.Add(Delays[i], FSimpleDelegate::CreateLambda([RawState]() { RawState->WheelFired++; }));
+		}
+		for (int32 i = 0; i < NumTimers; i += 2)
+		{
+			State->Wheel.Remove(Handles[i]);
+			Handles[i] = State->Wheel.Add(Delays[NumTimers - 1 - i], FSimpleDelegate::CreateLambda([RawState]() { RawState->WheelFired++; }));
+		}
+		AddInfo(FString::Printf(TEXT("Timing wheel: schedule/cancel %.3f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0));
+	}
+
+	{
+		TArray<FTimerHandle> Handles;
+		Handles.SetNum(NumTimers);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumTimers; i++)
+		{
+			State->TimerManager.SetTimer(Handles[i], FTimerDelegate::CreateLambda([RawState]() { RawState->TimerManagerFired++; }), Delays[i], false);
+		}
+		for (int32 i = 0; i < NumTimers; i += 2)
+		{
+			State->TimerManager.ClearTimer(Handles[i]);
+			State->TimerManager.SetTimer(Handles[i], FTimerDelegate::CreateLambda([RawState]() { RawState->TimerManagerFired++; }), Delays[NumTimers - 1 - i], false);
+		}
+		AddInfo(FString::Printf(TEXT("FTimerManager: schedule/cancel %.3f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0));
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FTimerBenchmarkFrameCommand(State, this));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
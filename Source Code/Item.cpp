@@ -5,12 +5,17 @@
 #include "Components/SphereComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "ItemPoolSubsystem.h"
+#include "RotatingItemSubsystem.h"
+#include "WorldStateSubsystem.h"
+#include "Engine/GameInstance.h"
 
 // Sets default values
 AItem::AItem()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
+	// Rotation used to be the only thing we ticked for, and the rotating item subsystem does that for all of us at once now
 
 	CollisionVolume = CreateDefaultSubobject<USphereComponent>(TEXT("CollisionVolume"));
 	RootComponent = CollisionVolume;
@@ -23,6 +28,10 @@ AItem::AItem()
 
 	bRotate = false;
 	RotationRate = 45.f;
+	RotatorIndex = INDEX_NONE;
+
+	bPoolable = false;
+	bInPool = false;
 
 }
 
@@ -34,21 +43,43 @@ void AItem::BeginPlay()
 	// Need to be allowed to run over the coin to collect it so we need to allow overlap
 	CollisionVolume->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnOverlapBegin);
 	CollisionVolume->OnComponentEndOverlap.AddDynamic(this, &AItem::OnOverlapEnd);
+
+	UpdateRotationRegistration();
 	
 }
 
-// Called every frame
-void AItem::Tick(float DeltaTime)
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
-
-	if (bRotate)
+	URotatingItemSubsystem* Rotator = GetWorld()->GetSubsystem<URotatingItemSubsystem>();
+	if (Rotator)
 	{
-		FRotator Rotation = GetActorRotation();
-		Rotation.Yaw += DeltaTime * RotationRate;
-		SetActorRotation(Rotation);
+		Rotator->UnregisterItem(this);
 	}
 
+	Super::EndPlay(EndPlayReason);
+}
+
+void AItem::SetRotating(bool bShouldRotate)
+{
+	bRotate = bShouldRotate;
+	UpdateRotationRegistration();
+}
+
+void AItem::UpdateRotationRegistration()
+{
+	URotatingItemSubsystem* Rotator = GetWorld()->GetSubsystem<URotatingItemSubsystem>();
+	if (Rotator)
+	{
+		// Nothing in the pool needs to spin, nobody can see it
+		if (bRotate && !bInPool)
+		{
+			Rotator->RegisterItem(this);
+		}
+		else
+		{
+			Rotator->UnregisterItem(this);
+		}
+	}
 }
 
 void AItem::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
@@ -59,4 +90,42 @@ void AItem::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* Oth
 void AItem::OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
 
-}
\ No newline at end of file
+}
+
+void AItem::Consume()
+{
+	// Pickups and explosives placed in the level stay gone after a save and load
+	UWorldStateSubsystem* WorldState = GetGameInstance() ? GetGameInstance()->GetSubsystem<UWorldStateSubsystem>() : nullptr;
+	if (WorldState)
+	{
+		WorldState->RecordConsumed(this);
+	}
+
+	UItemPoolSubsystem* Pool = GetWorld()->GetSubsystem<UItemPoolSubsystem>();
+	if (bPoolable && Pool)
+	{
+		Pool->Release(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void AItem::SetPoolActive(bool bActive)
+{
+	bInPool = !bActive;
+
+	SetActorHiddenInGame(!bActive);
+	SetActorEnableCollision(bActive);
+	UpdateRotationRegistration();
+
+	if (bActive)
+	{
+		IdleParticlesComponent->Activate(true); // Restart them from the beginning
+	}
+	else
+	{
+		IdleParticlesComponent->Deactivate();
+	}
+}
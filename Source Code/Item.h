@@ -36,19 +36,37 @@ public:
 	class USoundCue* OverlapSound;
 
 	// Rotational functionality
+	// Items don't tick anymore, the URotatingItemSubsystem spins everything with bRotate set. Use SetRotating to change it during play
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Properties")
 	bool bRotate; // Don't want everything to rotate, only things we set so we make it a bool
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Properties")
 	float RotationRate;
 
+	/** Our slot in the rotating item subsystem, INDEX_NONE when we aren't registered */
+	int32 RotatorIndex;
+
+	/** Opt in to pooling. When consumed we get hidden and handed back to the item pool instead of being destroyed */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item | Pooling")
+	bool bPoolable;
+
+	/** True while we're sitting in the pool waiting to be spawned again */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item | Pooling")
+	bool bInPool;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Registers with or unregisters from the rotating item subsystem to match bRotate */
+	void UpdateRotationRegistration();
+
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/** Starts or stops us spinning */
+	UFUNCTION(BlueprintCallable, Category = "Item | Properties")
+	void SetRotating(bool bShouldRotate);
 
 	UFUNCTION()
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
@@ -56,4 +74,10 @@ public:
 	UFUNCTION()
 	virtual void OnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
 
+	/** Use this instead of Destroy() once the item has been picked up or set off. Poolable items go back to the pool, everything else is destroyed */
+	void Consume();
+
+	/** Hides us, turns off collision and our idle particles while we're in the pool, or turns it all back on */
+	virtual void SetPoolActive(bool bActive);
+
 };
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemPoolSubsystem.h"
+#include "MyProject.h"
+#include "Item.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Item Pool Hits"), STAT_ItemPoolHits, STATGROUP_MyProject);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Item Pool Misses"), STAT_ItemPoolMisses, STATGROUP_MyProject);
+
+void UItemPoolSubsystem::Prewarm(TSubclassOf<AItem> ItemClass, int32 Count, const FVector& Location)
+{
+	if (ItemClass == nullptr) return;
+
+	FItemPool& Pool = Pools.FindOrAdd(ItemClass);
+	while (Pool.Inactive.Num() < Count)
+	{
+		AItem* Item = GetWorld()->SpawnActor<AItem>(ItemClass, Location, FRotator::ZeroRotator);
+		if (Item == nullptr) break;
+
+		Item->SetPoolActive(false);
+		Pool.Inactive.Add(Item);
+	}
+}
+
+AItem* UItemPoolSubsystem::Acquire(TSubclassOf<AItem> ItemClass, const FVector& Location, const FRotator& Rotation)
+{
+	if (ItemClass == nullptr) return nullptr;
+
+	FItemPool& Pool = Pools.FindOrAdd(ItemClass);
+	while (Pool.Inactive.Num() > 0)
+	{
+		AItem* Item = Pool.Inactive.Pop(false);
+		if (Item == nullptr || Item->IsPendingKill()) continue;
+
+		INC_DWORD_STAT(STAT_ItemPoolHits);
+
+		Item->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		Item->SetPoolActive(true);
+		return Item;
+	}
+
+	INC_DWORD_STAT(STAT_ItemPoolMisses);
+	return GetWorld()->SpawnActor<AItem>(ItemClass, Location, Rotation);
+}
+
+void UItemPoolSubsystem::Release(AItem* Item)
+{
+	if (Item == nullptr || Item->bInPool) return; // Already back in the pool, e.g. two overlaps in the same frame
+
+	Item->SetPoolActive(false);
+	Pools.FindOrAdd(Item->GetClass()).Inactive.Add(Item);
+
+	OnItemReleased.Broadcast(Item);
+}
+
+int32 UItemPoolSubsystem::GetNumInactive(TSubclassOf<AItem> ItemClass) const
+{
+	const FItemPool* Pool = Pools.Find(ItemClass);
+	return Pool ? Pool->Inactive.Num() : 0;
+}
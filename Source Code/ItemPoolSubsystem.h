@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemPoolSubsystem.generated.h"
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnItemReleased, class AItem*);
+
+USTRUCT()
+struct FItemPool
+{
+	GENERATED_BODY()
+
+	/** Consumed items of one class, hidden and waiting to be spawned again */
+	UPROPERTY()
+	TArray<class AItem*> Inactive;
+};
+
+/**
+ * Pool for short lived items like coins, potions and explosives. Items opt in with AItem::bPoolable
+ * Consumed items come here instead of being destroyed, and spawners take them back out instead of building new actors
+ */
+UCLASS()
+class MYPROJECT_API UItemPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Makes sure at least Count inactive items of this class are waiting in the pool */
+	void Prewarm(TSubclassOf<AItem> ItemClass, int32 Count, const FVector& Location);
+
+	/** Takes an item out of the pool and puts it at Location, or spawns a new one if the pool is empty */
+	AItem* Acquire(TSubclassOf<AItem> ItemClass, const FVector& Location, const FRotator& Rotation);
+
+	/** Hands a consumed item back to the pool */
+	void Release(AItem* Item);
+
+	/** Fires for every item handed back, so whoever spawned it knows it's gone without having to poll */
+	FOnItemReleased OnItemReleased;
+
+	int32 GetNumInactive(TSubclassOf<AItem> ItemClass) const;
+
+private:
+	UPROPERTY()
+	TMap<UClass*, FItemPool> Pools;
+};
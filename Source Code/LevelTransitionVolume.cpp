@@ -4,6 +4,14 @@
 #include "LevelTransitionVolume.h"
 #include "Components/BoxComponent.h"
 #include "Components/BillboardComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/LevelStreaming.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/GameInstance.h"
+#include "AssetPrefetchSubsystem.h"
+#include "Misc/PackageName.h"
 #include "Main.h"
 
 // Sets default values
@@ -23,6 +31,26 @@ ALevelTransitionVolume::ALevelTransitionVolume()
 	// With this, we won't change levels unless we're not in the SunTemple level anymore
 	// This way we can test it in blueprints to make sure it works
 
+	PrefetchSphere = CreateDefaultSubobject<USphereComponent>(TEXT("PrefetchSphere"));
+	PrefetchSphere->SetupAttachment(GetRootComponent());
+	PrefetchSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	PrefetchSphere->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+
+	bStreamingTransition = false; // Off by default so existing volumes keep doing a full OpenLevel
+	PrefetchRadius = 3000.f;
+	bUnloadSourceLevel = true;
+
+	DestinationStreaming = nullptr;
+	bPrefetchedDestination = false;
+	bTransitionStarted = false;
+}
+
+void ALevelTransitionVolume::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	// Keep the sphere in step with the property so the radius can be seen in the editor
+	PrefetchSphere->SetSphereRadius(PrefetchRadius);
 }
 
 // Called when the game starts or when spawned
@@ -31,6 +59,10 @@ void ALevelTransitionVolume::BeginPlay()
 	Super::BeginPlay();
 
 	TransitionVolume->OnComponentBeginOverlap.AddDynamic(this, &ALevelTransitionVolume::OnOverlapBegin);
+
+	// Both kinds of transition use the sphere, a full travel to warm the next level's assets and a streaming one to load the level too
+	PrefetchSphere->OnComponentBeginOverlap.AddDynamic(this, &ALevelTransitionVolume::OnPrefetchOverlapBegin);
+	PrefetchSphere->OnComponentEndOverlap.AddDynamic(this, &ALevelTransitionVolume::OnPrefetchOverlapEnd);
 }
 
 // Called every frame
@@ -51,8 +83,211 @@ void ALevelTransitionVolume::OnOverlapBegin(UPrimitiveComponent* OverlappedCompo
 		UE_LOG(LogTemp, Warning, TEXT("OtherActor Valid"));
 		AMain* Main = Cast<AMain>(OtherActor);
 		if (Main)
+		{
+			if (bStreamingTransition)
+			{
+				StartStreamingTransition();
+			}
+			else
+			{
+				Main->SwitchLevel(TransitionLevelName);
+			}
+		}
+	}
+}
+
+void ALevelTransitionVolume::OnPrefetchOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
+{
+	if (Cast<AMain>(OtherActor) == nullptr) return;
+
+	UGameInstance* GameInstance = GetGameInstance();
+	UAssetPrefetchSubsystem* Prefetcher = GameInstance ? GameInstance->GetSubsystem<UAssetPrefetchSubsystem>() : nullptr;
+	if (Prefetcher)
+	{
+		Prefetcher->PrefetchLevel(TransitionLevelName);
+	}
+
+	if (bStreamingTransition)
+	{
+		PrefetchDestination();
+	}
+}
+
+void ALevelTransitionVolume::OnPrefetchOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	if (Cast<AMain>(OtherActor) && bStreamingTransition && !bTransitionStarted)
+	{
+		CancelPrefetch();
+	}
+}
+
+void ALevelTransitionVolume::PrefetchDestination()
+{
+	if (DestinationStreaming) return;
+
+	UWorld* World = GetWorld();
+	if (World == nullptr) return;
+
+	// Loading a map as a level instance would put its own PlayerStarts, game mode settings and lighting next to ours,
+	// so a separate map always goes through OpenLevel
+	DestinationStreaming = FindDestinationSublevel();
+	if (DestinationStreaming == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: %s isn't a sublevel of %s, falling back to OpenLevel"), *GetName(), *TransitionLevelName.ToString(), *World->GetMapName());
+		return;
+	}
+
+	// Already there, e.g. another volume streamed it in. Leave it as it is and don't unload it if the player turns back
+	if (DestinationStreaming->ShouldBeLoaded()) return;
+
+	// Load in the background but keep it hidden, adding it to the world is what the transition is for
+	bPrefetchedDestination = true;
+	DestinationStreaming->SetShouldBeLoaded(true);
+	if (!bTransitionStarted)
+	{
+		DestinationStreaming->SetShouldBeVisible(false);
+	}
+}
+
+void ALevelTransitionVolume::CancelPrefetch()
+{
+	if (DestinationStreaming == nullptr) return;
+
+	if (bPrefetchedDestination)
+	{
+		DestinationStreaming->SetShouldBeLoaded(false);
+	}
+
+	DestinationStreaming = nullptr;
+	bPrefetchedDestination = false;
+}
+
+void ALevelTransitionVolume::StartStreamingTransition()
+{
+	if (bTransitionStarted) return;
+
+	// In case the player got here without passing through the prefetch sphere, e.g. a radius smaller than the box
+	PrefetchDestination();
+
+	if (DestinationStreaming == nullptr)
+	{
+		AMain* Main = Cast<AMain>(UGameplayStatics::GetPlayerCharacter(this, 0));
+		if (Main)
 		{
 			Main->SwitchLevel(TransitionLevelName);
 		}
+		return;
+	}
+
+	bTransitionStarted = true;
+
+	DestinationStreaming->SetShouldBeVisible(true);
+	if (DestinationStreaming->IsLevelVisible())
+	{
+		OnDestinationShown();
+	}
+	else
+	{
+		// The level is added to the world a slice at a time over the next few frames, so we wait for it rather than block
+		DestinationStreaming->OnLevelShown.AddDynamic(this, &ALevelTransitionVolume::OnDestinationShown);
+	}
+}
+
+void ALevelTransitionVolume::OnDestinationShown()
+{
+	if (DestinationStreaming == nullptr) return;
+	DestinationStreaming->OnLevelShown.RemoveDynamic(this, &ALevelTransitionVolume::OnDestinationShown);
+
+	AMain* Main = Cast<AMain>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	if (Main)
+	{
+		// The pawn carries on from wherever it was, so it has to be moved into the new level by hand
+		APlayerStart* PlayerStart = FindDestinationPlayerStart();
+		if (PlayerStart)
+		{
+			Main->TeleportTo(PlayerStart->GetActorLocation(), PlayerStart->GetActorRotation());
+			if (Main->GetController())
+			{
+				Main->GetController()->SetControlRotation(PlayerStart->GetActorRotation());
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: no PlayerStart tagged '%s' in %s, leaving the player where they are"),
+				*GetName(), *DestinationPlayerStartTag.ToString(), *TransitionLevelName.ToString());
+		}
+
+		// Same handoff and autosave SwitchLevel does, with the sublevel we're now in so a load puts us back here and not in the map's first area
+		const FName StreamedLevelName(*FPackageName::GetShortName(UWorld::RemovePIEPrefix(DestinationStreaming->GetWorldAssetPackageName())));
+		Main->CurrentStreamedLevel = StreamedLevelName;
+		Main->HandOffForLevelTransition(FName(*UGameplayStatics::GetCurrentLevelName(this, true)), StreamedLevelName);
+	}
+
+	if (!bUnloadSourceLevel) return;
+
+	ULevelStreaming* SourceStreaming = FindStreamingLevelFor(GetLevel());
+	if (SourceStreaming == nullptr || SourceStreaming == DestinationStreaming) return;
+
+	// This actor lives in the source level and goes away with it, so this has to be the last thing we do
+	SourceStreaming->SetShouldBeVisible(false);
+	SourceStreaming->SetShouldBeLoaded(false);
+}
+
+ULevelStreaming* ALevelTransitionVolume::FindDestinationSublevel() const
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+
+	const FName DestinationPackage = DestinationLevel.IsNull() ? NAME_None : FName(*DestinationLevel.ToSoftObjectPath().GetLongPackageName());
+
+	for (ULevelStreaming* Streaming : World->GetStreamingLevels())
+	{
+		if (Streaming == nullptr) continue;
+
+		// In PIE the sublevel packages carry a prefix the soft reference doesn't
+		const FName Package(*UWorld::RemovePIEPrefix(Streaming->GetWorldAssetPackageName()));
+		if (!DestinationPackage.IsNone())
+		{
+			if (Package == DestinationPackage) return Streaming;
+		}
+		else if (FName(*FPackageName::GetShortName(Package)) == TransitionLevelName)
+		{
+			return Streaming;
+		}
 	}
+
+	return nullptr;
+}
+
+APlayerStart* ALevelTransitionVolume::FindDestinationPlayerStart() const
+{
+	const ULevel* Level = DestinationStreaming ? DestinationStreaming->GetLoadedLevel() : nullptr;
+	if (Level == nullptr) return nullptr;
+
+	for (AActor* Actor : Level->Actors)
+	{
+		APlayerStart* PlayerStart = Cast<APlayerStart>(Actor);
+		if (PlayerStart && (DestinationPlayerStartTag.IsNone() || PlayerStart->PlayerStartTag == DestinationPlayerStartTag))
+		{
+			return PlayerStart;
+		}
+	}
+
+	return nullptr;
+}
+
+ULevelStreaming* ALevelTransitionVolume::FindStreamingLevelFor(const ULevel* Level) const
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr || Level == nullptr || Level == World->PersistentLevel) return nullptr;
+
+	for (ULevelStreaming* Streaming : World->GetStreamingLevels())
+	{
+		if (Streaming && Streaming->GetLoadedLevel() == Level)
+		{
+			return Streaming;
+		}
+	}
+
+	return nullptr;
 }
\ No newline at end of file
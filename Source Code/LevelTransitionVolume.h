@@ -23,6 +23,41 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
 	FName TransitionLevelName; // The name of the level we want to transition to
+
+	/**
+	 * Stream the destination in next to the current level instead of travelling to it. The pawn, controller and HUD
+	 * all carry on as they are: the player is moved to the destination's PlayerStart, and the level this volume lives in is
+	 * unloaded once the new one is showing
+	 *
+	 * Only works between sublevels of the same persistent map. Every map we ship so far is its own persistent level, so this
+	 * needs a map set up with its areas as sublevels. Anywhere else it falls back to SwitchLevel and OpenLevel
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition|Streaming")
+	bool bStreamingTransition;
+
+	/** The sublevel to stream in. It has to be one of this map's streaming levels. Left empty, the sublevel called TransitionLevelName is used */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition|Streaming", meta = (EditCondition = "bStreamingTransition"))
+	TSoftObjectPtr<UWorld> DestinationLevel;
+
+	/** PlayerStart in the destination to put the player on, matched on its PlayerStartTag. Left empty, the first one in the level is used */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition|Streaming", meta = (EditCondition = "bStreamingTransition"))
+	FName DestinationPlayerStartTag;
+
+	/**
+	 * How close the player has to get before we start loading the destination in the background. Also when the prefetcher
+	 * starts on the destination's manifest assets, streaming or not
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition|Streaming", meta = (ClampMin = "0.0"))
+	float PrefetchRadius;
+
+	/** Unload the sublevel this volume is in after the transition. Does nothing if the volume is in the persistent level */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition|Streaming", meta = (EditCondition = "bStreamingTransition"))
+	bool bUnloadSourceLevel;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Transition|Streaming")
+	class USphereComponent* PrefetchSphere;
+
+	virtual void OnConstruction(const FTransform& Transform) override;
 	
 protected:
 	// Called when the game starts or when spawned
@@ -35,4 +70,41 @@ public:
 	UFUNCTION()
 	virtual void OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
 
+	UFUNCTION()
+	void OnPrefetchOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
+
+	UFUNCTION()
+	void OnPrefetchOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+
+	/** Starts loading the destination without showing it. Safe to call more than once */
+	UFUNCTION(BlueprintCallable, Category = "Transition|Streaming")
+	void PrefetchDestination();
+
+	/** Shows the destination, loading it first if the prefetch hasn't, moves the player over and then unloads this volume's level */
+	UFUNCTION(BlueprintCallable, Category = "Transition|Streaming")
+	void StartStreamingTransition();
+
+private:
+	UFUNCTION()
+	void OnDestinationShown();
+
+	/** Drops a prefetch the player walked away from, so a level we never enter doesn't sit in memory */
+	void CancelPrefetch();
+
+	/** The destination's streaming level, or null if it isn't a sublevel of this map */
+	class ULevelStreaming* FindDestinationSublevel() const;
+
+	/** The PlayerStart in the destination matching DestinationPlayerStartTag */
+	class APlayerStart* FindDestinationPlayerStart() const;
+
+	/** The streaming level that loaded Level, null for the persistent level */
+	class ULevelStreaming* FindStreamingLevelFor(const ULevel* Level) const;
+
+	UPROPERTY(Transient)
+	class ULevelStreaming* DestinationStreaming;
+
+	/** Whether we're the ones who asked for the destination to be loaded, and so ours to unload again if the player turns back */
+	bool bPrefetchedDestination;
+
+	bool bTransitionStarted;
 };
@@ -17,7 +17,22 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Enemy.h"
 #include "MainPlayerController.h"
+#include "MainHUDModel.h"
 #include "ItemStorage.h"
+#include "WeaponRegistrySubsystem.h"
+#include "PlayerSaveSubsystem.h"
+#include "WorldStateSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LevelStreaming.h"
+#include "GameFramework/GameModeBase.h"
+#include "EnemySpatialSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSpatialCombatTarget(
+	TEXT("MyProject.SpatialCombatTarget"),
+	1,
+	TEXT("1 = pick combat targets from the enemy spatial hash, 0 = use the old GetOverlappingActors search"),
+	ECVF_Default);
 
 // Sets default values
 AMain::AMain()
@@ -25,6 +40,8 @@ AMain::AMain()
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	StaminaComponent = CreateDefaultSubobject<UStaminaComponent>(TEXT("StaminaComponent"));
+
 	// Create CameraBoom (Pulls towards the player if there's a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(GetRootComponent());
@@ -106,6 +123,21 @@ void AMain::BeginPlay()
 	MainPlayerController = Cast<AMainPlayerController>(GetController()); // Returns an AControllerObject and stores it
 	// Call this as soon as we need to display a health bar
 
+	// Stamina only changes when we cross a threshold or press shift now, so the speed just has to be right to begin with
+	GetCharacterMovement()->MaxWalkSpeed = RunningSpeed;
+
+	StaminaComponent->OnStaminaStatusChanged.AddUObject(this, &AMain::OnStaminaStatusChanged);
+	StaminaComponent->Configure(MaxStamina, MinSprintStamina, StaminaDrainRate, Stamina, StaminaStatus);
+
+	// Give the HUD everything it needs up front, after this it only hears about changes
+	UMainHUDModel* HUDModel = GetHUDModel();
+	if (HUDModel)
+	{
+		HUDModel->SetStaminaSource(StaminaComponent);
+	}
+	PushHealthToHUD();
+	PushCoinsToHUD();
+
 	FString Map = GetWorld()->GetMapName();
 	Map.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
 
@@ -135,131 +167,8 @@ void AMain::Tick(float DeltaTime)
 
 	if (MovementStatus == EMovementStatus::EMS_Dead) return;
 
-	// How much the stamina should change in this particular frame for drain or recovery
-	float DeltaStamina = StaminaDrainRate * DeltaTime;
-	// Could have different floats for recover and drain, but the process is the same anyway so no real need unless you want one to be faster than the other
-
-	// Because of so many different statuses for Sprinting, Normal, BelowMinimum, Exhausted, etc., rather than do a bunch of if else statements...
-	// And we'll only be in one at any time, we should use a switch statement
-	switch (StaminaStatus)
-	{
-	case EStaminaStatus::ESS_Normal:
-		if (bShiftKeyDown)
-		{
-			// First going to check to see if we're in the normal state and draining stamina with the key down
-			// But before we drain stamina, we need to see if such a small change would put us BelowMinimum
-			if (Stamina - DeltaStamina <= MinSprintStamina)
-			{
-				// If this is the case we'll cross over to the BelowMinimum state
-				SetStaminaStatus(EStaminaStatus::ESS_BelowMinimum); // Change stamina bar color
-				Stamina -= DeltaStamina;
-			}
-			// However, if above isn't the case we're good to be in the normal state
-			else 
-			{
-				Stamina -= DeltaStamina; // Don't need to change the state, we're fine to just decrement stamina
-			}
-			// If the shift key is being held down, we want to be in sprinting, so we want to set that status
-			if (bMovingForward || bMovingRight)
-			{
-				SetMovementStatus(EMovementStatus::EMS_Sprinting);
-			}
-			else
-			{
-				SetMovementStatus(EMovementStatus::EMS_Normal);
-			}
-		}
-		else // Shift key up
-		{
-			// If we're in the Normal state and shift key is not down
-			// At this point our stamina should be replenishing
-			// But, we don't want it to regen past the maximum
-			if (Stamina + DeltaStamina >= MaxStamina)
-			{
-				Stamina = MaxStamina;
-			}
-			else
-			{
-				Stamina += DeltaStamina;
-			}
-			// If in normal state and shift key up, we shouldn't be sprinting
-			SetMovementStatus(EMovementStatus::EMS_Normal);
-		}
-		break;
-
-	case EStaminaStatus::ESS_BelowMinimum:
-		if (bShiftKeyDown)
-		{
-			if (Stamina - DeltaStamina <= 0.f)
-			{
-				// Set status to Exhausted
-				SetStaminaStatus(EStaminaStatus::ESS_Exhausted); // Change stamina bar color
-				Stamina = 0;
-				SetMovementStatus(EMovementStatus::EMS_Normal);
-				// If you're exhausted you can't sprint anymore and you run out of stamina
-			}
-			else
-			{
-				Stamina -= DeltaStamina;
-				// If we won't get to 0 stamina, we don't need to stop running, can still decrement
-				if (bMovingForward || bMovingRight)
-				{
-					SetMovementStatus(EMovementStatus::EMS_Sprinting);
-				}
-				else
-				{
-					SetMovementStatus(EMovementStatus::EMS_Normal);
-				}
-			}
-		}
-		else // Shift key up
-		{
-			if (Stamina + DeltaStamina >= MinSprintStamina)
-			{
-				// If recovery pushes past MinSprintStamina, set StaminaStatus back to normal again, and out of MinSprintStamina status
-				SetStaminaStatus(EStaminaStatus::ESS_Normal);
-				Stamina += DeltaStamina; // But also still recovering so can keep recovering
-			}
-			else
-			{
-				Stamina += DeltaStamina;
-			}
-			SetMovementStatus(EMovementStatus::EMS_Normal);
-		}
-		break;
-		
-	case EStaminaStatus::ESS_Exhausted:
-		if (bShiftKeyDown)
-		{
-			Stamina = 0.f;
-			// Reached the exhaustion point, and don't want to be running and draining more stamina
-			// Want the Player to let go of the key so stamina can regenerate
-		}
-		else // Shift key up
-		{
-			SetStaminaStatus(EStaminaStatus::ESS_ExhaustedRecovering); // Change stamina bar color
-			Stamina += DeltaStamina;
-		}
-		SetMovementStatus(EMovementStatus::EMS_Normal);
-		break;
-
-	case EStaminaStatus::ESS_ExhaustedRecovering:
-		if (Stamina + DeltaStamina >= MinSprintStamina)
-		{
-			// Should not be able to sprint until recovered, and check to see if recharge rate will put us back to MinSprintStamina level
-			SetStaminaStatus(EStaminaStatus::ESS_Normal);
-			Stamina += DeltaStamina;
-		}
-		else // If recovery doesn't put us above the MinSprintStamina level, keep recovering
-		{
-			Stamina += DeltaStamina;
-		}
-		SetMovementStatus(EMovementStatus::EMS_Normal); // Not in the sprinting status
-		break;
-
-	default:
-		break;
-	}
+	// Stamina used to be stepped through its states right here every frame
+	// The stamina component works out when the next state change will happen and only does anything then (see OnStaminaStatusChanged)
 
 	if (bInterpToEnemy && CombatTarget)
 	{
@@ -394,6 +303,8 @@ void AMain::MoveForward(float Value)
 
 		bMovingForward = true;
 	}
+
+	UpdateSprintMovement();
 }
 
 void AMain::MoveRight(float Value)
@@ -410,6 +321,8 @@ void AMain::MoveRight(float Value)
 
 		bMovingRight = true;
 	}
+
+	UpdateSprintMovement();
 }
 
 void AMain::TurnAtRate(float Rate)
@@ -502,11 +415,13 @@ void AMain::DecrementHealth(float Amount)
 	{
 		Health -= Amount;
 	}
+	PushHealthToHUD();
 }
 
 void AMain::IncrementCoins(int32 Amount)
 {
 	Coins += Amount;
+	PushCoinsToHUD();
 }
 
 void AMain::IncrementHealth(float Amount)
@@ -519,6 +434,7 @@ void AMain::IncrementHealth(float Amount)
 	{
 		Health += Amount;
 	}
+	PushHealthToHUD();
 }
 
 void AMain::Die()
@@ -553,6 +469,8 @@ void AMain::DeathEnd()
 
 void AMain::SetMovementStatus(EMovementStatus Status)
 {
+	if (MovementStatus == Status) return; // Writing MaxWalkSpeed when nothing changed is wasted work
+
 	MovementStatus = Status;
 	if (MovementStatus == EMovementStatus::EMS_Sprinting)
 	{
@@ -567,11 +485,84 @@ void AMain::SetMovementStatus(EMovementStatus Status)
 void AMain::ShiftKeyDown()
 {
 	bShiftKeyDown = true;
+	StaminaComponent->SetSprintHeld(true);
+	UpdateSprintMovement();
+	PushStaminaToHUD();
 }
 
 void AMain::ShiftKeyUp()
 {
 	bShiftKeyDown = false;
+	StaminaComponent->SetSprintHeld(false);
+	UpdateSprintMovement();
+	PushStaminaToHUD();
+}
+
+float AMain::GetStamina() const
+{
+	return StaminaComponent->GetStamina();
+}
+
+void AMain::SetStamina(float NewStamina)
+{
+	Stamina = NewStamina;
+	StaminaComponent->SetStamina(NewStamina);
+	UpdateSprintMovement();
+	PushStaminaToHUD();
+}
+
+void AMain::OnStaminaStatusChanged(EStaminaStatus Status)
+{
+	SetStaminaStatus(Status); // Change stamina bar color
+	UpdateSprintMovement(); // Running out of stamina stops the sprint
+	PushStaminaToHUD();
+}
+
+UMainHUDModel* AMain::GetHUDModel() const
+{
+	return MainPlayerController ? MainPlayerController->GetHUDModel() : nullptr;
+}
+
+void AMain::PushHealthToHUD()
+{
+	UMainHUDModel* HUDModel = GetHUDModel();
+	if (HUDModel)
+	{
+		HUDModel->SetHealth(Health, MaxHealth);
+	}
+}
+
+void AMain::PushCoinsToHUD()
+{
+	UMainHUDModel* HUDModel = GetHUDModel();
+	if (HUDModel)
+	{
+		HUDModel->SetCoins(Coins);
+	}
+}
+
+void AMain::PushStaminaToHUD()
+{
+	// The model follows the stamina component on its own while stamina is moving, it just needs to know the direction changed
+	UMainHUDModel* HUDModel = GetHUDModel();
+	if (HUDModel)
+	{
+		HUDModel->RefreshStamina();
+	}
+}
+
+void AMain::UpdateSprintMovement()
+{
+	if (MovementStatus == EMovementStatus::EMS_Dead) return;
+
+	if (bShiftKeyDown && (bMovingForward || bMovingRight) && StaminaComponent->CanSprint())
+	{
+		SetMovementStatus(EMovementStatus::EMS_Sprinting);
+	}
+	else
+	{
+		SetMovementStatus(EMovementStatus::EMS_Normal);
+	}
 }
 
 void AMain::ShowPickupLocations()
@@ -681,6 +672,7 @@ float AMain::TakeDamage(float DamageAmount, struct FDamageEvent const & DamageEv
 	{
 		Health -= DamageAmount;
 	}
+	PushHealthToHUD();
 
 	return DamageAmount;
 }
@@ -690,14 +682,22 @@ void AMain::UpdateCombatTarget()
 	// When our character kills an enemy we don't update our combat target to another enemy if we're facing multiple enemies
 	// It just stays on the enemy we killed
 	// So this function will be for updating the combat target
-	TArray<AActor*> OverlappingActors; // This TArray will be what we pass in to GetOverlappingActors
-	// It essentially just gives us an array of all overlapping actors, so we can see who we can target next
+	AEnemy* ClosestEnemy = nullptr;
 
-	GetOverlappingActors(OverlappingActors, EnemyFilter);
+	UEnemySpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UEnemySpatialSubsystem>();
+	if (SpatialSubsystem && CVarSpatialCombatTarget.GetValueOnGameThread() != 0)
+	{
+		// Ask the spatial hash for the closest live enemy whose aggro sphere reaches our capsule
+		// Usually the same answer as the overlap search below, which also counts the enemy's other components. It only looks at nearby cells and never takes a square root
+		const UCapsuleComponent* Capsule = GetCapsuleComponent();
+		ClosestEnemy = SpatialSubsystem->FindNearestAliveEnemy(GetActorLocation(), Capsule->GetScaledCapsuleRadius(), Capsule->GetScaledCapsuleHalfHeight(), EnemyFilter);
+	}
+	else
+	{
+		ClosestEnemy = FindClosestOverlappingEnemy();
+	}
 
-	// Iterate over the array we create and select the closest one to be the combat target
-	// But don't want to do that if the array is empty obviously
-	if (OverlappingActors.Num() == 0)
+	if (ClosestEnemy == nullptr)
 	{
 		// After we kill an enemy, if there's no other enemies overlapping, we remove the enemy health bar widget from the viewport
 		if(MainPlayerController)
@@ -707,43 +707,48 @@ void AMain::UpdateCombatTarget()
 		return;
 	}
 
-	// If there's at least one element in the array, we want to get the closest target
-	AEnemy* ClosestEnemy = Cast<AEnemy>(OverlappingActors[0]);
-	if(ClosestEnemy)
+	if (MainPlayerController)
 	{
-		FVector Location = GetActorLocation(); // Rather than constantly declare GetActorLocation, like we were in MinDistance, just make a variable for it that we can use
-		float MinDistance = (ClosestEnemy->GetActorLocation() - Location).Size(); // Gives us a float in distance from our PC to the enemy
-		// The parenthesis gives us a vector, then Size() turns it to a float, so we'll have a float in distance
-		// But this is just the first character in the array so we need to loop through the array and see if there are any more who are closer
+		MainPlayerController->DisplayEnemyHealthBar(); // Display the closest enemy health bar
+	}
+	SetCombatTarget(ClosestEnemy);
+	bHasCombatTarget = true;
+}
 
-		// range based for loop since we don't care about the index in this case
-		for (auto Actor : OverlappingActors)
+AEnemy* AMain::FindClosestOverlappingEnemy()
+{
+	// The original way of finding a target, kept around so we can compare it against the spatial hash (MyProject.SpatialCombatTarget 0)
+	TArray<AActor*> OverlappingActors; // This TArray will be what we pass in to GetOverlappingActors
+	// It essentially just gives us an array of all overlapping actors, so we can see who we can target next
+
+	GetOverlappingActors(OverlappingActors, EnemyFilter);
+
+	AEnemy* ClosestEnemy = nullptr;
+	FVector Location = GetActorLocation(); // Rather than constantly declare GetActorLocation, just make a variable for it that we can use
+	float MinDistanceSquared = MAX_flt;
+
+	// range based for loop since we don't care about the index in this case
+	for (auto Actor : OverlappingActors)
+	{
+		// Each iteration through the loop, the "auto Actor" is going to be the Actor in OverlappingActors at that particular index
+		AEnemy* Enemy = Cast<AEnemy>(Actor); // Cast Actor to Enemy so we know that it's an Enemy
+		if (Enemy)
 		{
-			// This for loop will give us basically whatever Actor OverlappingActors contains, looping through the whole array
-			// Each iteration through the loop, the "auto Actor" is going to be the Actor in OverlappingActors at that particular index
-			AEnemy* Enemy = Cast<AEnemy>(Actor); // Cast Actor to Enemy so we know that it's an Enemy
-			if (Enemy)
+			// Squared distance is fine for finding the smallest, so skip the square root
+			float DistanceSquared = (Enemy->GetActorLocation() - Location).SizeSquared();
+			if (DistanceSquared < MinDistanceSquared)
 			{
-				float DistanceToActor = (Enemy->GetActorLocation() - Location).Size();
-				// See if this Distance is smaller than MinDistance
-				if (DistanceToActor < MinDistance)
-				{
-					MinDistance = DistanceToActor;
-					ClosestEnemy = Enemy;
-					// Update the closest enemy and the MinDistance as well
-				}
+				MinDistanceSquared = DistanceSquared;
+				ClosestEnemy = Enemy;
+				// Update the closest enemy and the MinDistance as well
 			}
 		}
-		if (MainPlayerController)
-		{
-			MainPlayerController->DisplayEnemyHealthBar(); // Display the closest enemy health bar
-		}
-		SetCombatTarget(ClosestEnemy);
-		bHasCombatTarget = true;
 	}
+
+	return ClosestEnemy;
 }
 
-void AMain::SwitchLevel(FName LevelName)
+void AMain::SwitchLevel(FName LevelName, FName StreamedLevelName)
 {
 	// First check to make sure the level name isn't what we're already at 
 	// To do that, need to use a special function from World called GetMapName()
@@ -759,6 +764,8 @@ void AMain::SwitchLevel(FName LevelName)
 		// * will make it a string literal (Only way to get the string literal from an FString is using the dereference operator, the *)
 		if (CurrentLevelName != LevelName)
 		{
+			HandOffForLevelTransition(LevelName, StreamedLevelName);
+
 			// If the level's name we're on is NOT the same as the level we want to transition to, we can run this code
 			// To transition to a different level:
 			UGameplayStatics::OpenLevel(World, LevelName);
@@ -769,159 +776,200 @@ void AMain::SwitchLevel(FName LevelName)
 	}
 }
 
-void AMain::SaveGame()
+void AMain::HandOffForLevelTransition(FName LevelName, FName StreamedLevelName)
 {
-	// To save the game, we need to create an instance of our SaveGame object, and UGameplayStatics has a function for that
-	UFirstSaveGame* SaveGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
-	// CreateSaveGameObject takes a TSubclassOf, but we haven't made one
-	// That's where UFirstSaveGame::StaticClass() comes in, this will return a value that's compatible with TSubclassOf
-	// It will return a UClass of type UFirstSaveGame
-	// An example is our enemy class. If you needed a TSubclassOf for the Enemy we would want a variable that we would set in blueprints, because the enemy...
-	// ... has a bunch of stuff we set in blueprints, so we wouldn't want to call StaticClass because none of those things would be set, they'd be in default values...
-	// ... unless we hard coded them, so that's not a good situation
-	// But in this case, for UFirstSaveGame, we can use StaticClass
-	// And since CreateSaveGameObject creates a USaveGame object, we need to cast it to UFirstSaveGame
-	
-	// In short, what we're doing is we're passing in what's returned from StaticClass, which is a UClass, and that's being passed in for our CreateSaveGameObject function...
-	// And that creates an object of type USaveGame, we're casting it to UFirstSaveGame, and then we're finally storing that in SaveGameInstance
-	// So now we have an instance of the Save Game Object we created
-	// Once we have one of those we can start setting its variables
-	SaveGameInstance->CharacterStats.Health = Health; // Here we're storing the main characters current health in the struct we made
-	SaveGameInstance->CharacterStats.MaxHealth = MaxHealth;
-	SaveGameInstance->CharacterStats.Stamina = Stamina;
-	SaveGameInstance->CharacterStats.MaxStamina = MaxStamina;
-	SaveGameInstance->CharacterStats.Coins = Coins;
+	// Hand our stats to the save subsystem so the next level's BeginPlay can pick them up from memory
+	// It also writes an autosave in the background, so the file on disk points at the level we're going to
+	UPlayerSaveSubsystem* SaveSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UPlayerSaveSubsystem>() : nullptr;
+	if (SaveSubsystem == nullptr) return;
+
+	FCharacterStats Stats;
+	GatherCharacterStats(Stats);
+
+	// Going to another map means where we're standing means nothing there. Whoever loads this starts at that map's PlayerStart instead
+	Stats.bUsePlayerStart = Stats.LevelName != LevelName.ToString();
+	Stats.LevelName = LevelName.ToString();
+	Stats.StreamedLevelName = StreamedLevelName.IsNone() ? TEXT("") : StreamedLevelName.ToString();
+	if (SaveSubsystem->bAutosaveOnLevelTransition)
+	{
+		SaveSubsystem->SaveAsync(Stats);
+	}
+	else
+	{
+		SaveSubsystem->SetPlayerState(Stats);
+	}
+}
+
+void AMain::RestoreStreamedLevel(FName StreamedLevelName)
+{
+	// Saves from before any streaming transition leave the map's sublevels however they are
+	if (StreamedLevelName.IsNone() || StreamedLevelName == CurrentStreamedLevel) return;
+
+	// Not one of this map's sublevels, so the save is for a different map and the one we travel to will show it
+	ULevelStreaming* Saved = UGameplayStatics::GetStreamingLevel(this, StreamedLevelName);
+	if (Saved == nullptr) return;
+
+	ULevelStreaming* Current = CurrentStreamedLevel.IsNone() ? nullptr : UGameplayStatics::GetStreamingLevel(this, CurrentStreamedLevel);
+	if (Current)
+	{
+		Current->SetShouldBeVisible(false);
+		Current->SetShouldBeLoaded(false);
+	}
+
+	Saved->SetShouldBeLoaded(true);
+	Saved->SetShouldBeVisible(true);
+	UGameplayStatics::FlushLevelStreaming(this);
+
+	CurrentStreamedLevel = StreamedLevelName;
+}
+
+void AMain::GatherCharacterStats(FCharacterStats& OutStats) const
+{
+	// Everything we want to keep between levels and saves, copied into the struct from FirstSaveGame.h
+	OutStats.Health = Health; // Here we're storing the main characters current health in the struct we made
+	OutStats.MaxHealth = MaxHealth;
+	OutStats.Stamina = GetStamina();
+	OutStats.MaxStamina = MaxStamina;
+	OutStats.Coins = Coins;
 
 	// Save the level name
 	FString MapName = GetWorld()->GetMapName();
 	MapName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
 	// This will strip away the prefix prepended to every UE map name and just leave us the actual map name
 	// This way we can actually save the map name and load it without any issues
-	SaveGameInstance->CharacterStats.LevelName = MapName;
+	OutStats.LevelName = MapName;
+	// That's the persistent map, which doesn't change with a streaming transition. The sublevel we streamed into goes alongside it
+	OutStats.StreamedLevelName = CurrentStreamedLevel.IsNone() ? TEXT("") : CurrentStreamedLevel.ToString();
+	OutStats.bUsePlayerStart = false; // We're standing on this map, so Location is good
 
 	// Save weapons (But first check to make sure we have an equipped weapon)
-	if (EquippedWeapon)
-	{
-		SaveGameInstance->CharacterStats.WeaponName = EquippedWeapon->Name;
-	}
-
-	SaveGameInstance->CharacterStats.Location = GetActorLocation();
-	SaveGameInstance->CharacterStats.Rotation = GetActorRotation();
-
-	// Now that we have the struct populated with relevant data from the time we save our game, we can call another UGameplayStatics function to save it
-	UGameplayStatics::SaveGameToSlot(SaveGameInstance, SaveGameInstance->PlayerName, SaveGameInstance->UserIndex);
-	// Once we call this our SaveGameInstance will have all of its data saved to your computers memory
+	OutStats.WeaponName = EquippedWeapon ? EquippedWeapon->Name : TEXT("");
 
+	OutStats.Location = GetActorLocation();
+	OutStats.Rotation = GetActorRotation();
 }
 
-void AMain::LoadGame(bool bSetPosition)
+void AMain::ApplyCharacterStats(const FCharacterStats& Stats, bool bSetPosition)
 {
-	// This will work, at least at the start, similar to SaveGame()
-	// First we'll want to create an instance of the UFirstSaveGame class
-	UFirstSaveGame* LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
-	// as you can see, this is exactly the same steps we need for saving so far
-	// But now we need to actually load our saved data, which is another GameplayStatics function
-
-	LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(LoadGameInstance->PlayerName, LoadGameInstance->UserIndex));
-	// In order to access the CharacterStats struct, we need to cast this to a UFirstSaveGame 
-	// This will take what's returned from LoadGameFromSlot, which is a USaveGame object, and cast it to a UFirstSaveGame and saving it back into LoadGameInstance
-	// Can overwrite it in this manner because the compiler will read it from right to left, so it'll use the data that's already saved, and then overwrite it
-
-	// So now that we have a LoadGameInstance that is filled with the data from when we last saved it, we can access that data
-	// What we're gonna do with that data is set those variables in main to what we saved, so basically the opposite of what we did in SaveGameInstance
-	Health = LoadGameInstance->CharacterStats.Health;
-	MaxHealth = LoadGameInstance->CharacterStats.MaxHealth;
-	Stamina = LoadGameInstance->CharacterStats.Stamina;
-	MaxStamina = LoadGameInstance->CharacterStats.MaxStamina;
-	Coins = LoadGameInstance->CharacterStats.Coins;
-
-	// Before we can load our weapon, we need to do a few things
-	// We need to create an instance of our WeaponStorage and use that Actor
-	// First check to see if WeaponStorage is valid, to ensure we don't crash
-	if (WeaponStorage)
-	{
-		AItemStorage* Weapons = GetWorld()->SpawnActor<AItemStorage>(WeaponStorage);
-		// This way we have what's returned from SpawnActor stored in Weapons
-		if (Weapons)
-		{
-			// In Weapons we have access to that Map we created that are linked to actual weapon BP's, so we can use their names to spawn those weapons
-			// This will load all the particle systems, sounds, and everything linked to those blueprints
-			// So we're gonna access that map
-			FString WeaponName = LoadGameInstance->CharacterStats.WeaponName;
+	// Set the variables in main to what we saved, so basically the opposite of GatherCharacterStats
+	Health = Stats.Health;
+	MaxHealth = Stats.MaxHealth;
+	Stamina = Stats.Stamina;
+	MaxStamina = Stats.MaxStamina;
+	Coins = Stats.Coins;
+	StaminaComponent->Configure(MaxStamina, MinSprintStamina, StaminaDrainRate, Stamina, StaminaStatus);
+	PushHealthToHUD();
+	PushCoinsToHUD();
+	PushStaminaToHUD();
 
-			// Make sure the weapon name isn't empty
-			if (WeaponName != TEXT(""))
-			{
-				if (Weapons->WeaponMap.Contains(WeaponName)) // This check is to make sure we don't try to look for something that isn't there, and crash the engine
-				{
-					AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(Weapons->WeaponMap[WeaponName]);
-					WeaponToEquip->Equip(this);
-				}
-				// So with this we can spawn our weapon
-				// Now with the weapon spawned, we need to equip it
-				// Weapon class has the functionality to equip it to our character!
-			}			
-		}
+	// Before the position below, which may well be in that sublevel
+	RestoreStreamedLevel(FName(*Stats.StreamedLevelName));
+
+	// Weapons are looked up by name in the weapon registry, which only loads the one class we need (in the background, if it isn't in memory yet)
+	// We used to spawn an AItemStorage here just to read its WeaponMap, which loaded every weapon and left the actor behind
+	PendingWeaponName = NAME_None;
+	UWeaponRegistrySubsystem* WeaponRegistry = GetGameInstance() ? GetGameInstance()->GetSubsystem<UWeaponRegistrySubsystem>() : nullptr;
+	if (WeaponRegistry && Stats.WeaponName != TEXT("")) // Make sure the weapon name isn't empty
+	{
+		// Blueprints that still point WeaponStorage at an item storage class get read from its defaults instead of spawning it
+		WeaponRegistry->RegisterItemStorage(WeaponStorage);
+
+		PendingWeaponName = FName(*Stats.WeaponName);
+		WeaponRegistry->RequestWeaponClass(PendingWeaponName, FOnWeaponClassLoaded::CreateUObject(this, &AMain::OnSavedWeaponLoaded));
 	}
 
 	// We can't set actor location and rotation the same way we saved it, however, because any time we change to a new level the game essentially launches itself again
 	// BeginPlay will run again, so we essentially have to load all the stats we saved. In doing so, we'll attempt to load the actors location and rotation
 	// So in moving to a new level, we may end up spawning the player in some random location not at all relevant to where they're supposed to spawn, which would be bad!
 	// So instead we create a boolean to check if we're changing levels or not
-	if (bSetPosition)
+	if (bSetPosition && Stats.bUsePlayerStart)
 	{
-		SetActorLocation(LoadGameInstance->CharacterStats.Location);
-		SetActorRotation(LoadGameInstance->CharacterStats.Rotation);
+		// Saved on the way out of another map, so Location is from there. Go where this map starts the player instead
+		AGameModeBase* GameMode = UGameplayStatics::GetGameMode(this);
+		AActor* PlayerStart = (GameMode && GetController()) ? GameMode->FindPlayerStart(GetController()) : nullptr;
+		if (PlayerStart)
+		{
+			TeleportTo(PlayerStart->GetActorLocation(), PlayerStart->GetActorRotation());
+			GetController()->SetControlRotation(PlayerStart->GetActorRotation());
+		}
+	}
+	else if (bSetPosition)
+	{
+		SetActorLocation(Stats.Location);
+		SetActorRotation(Stats.Rotation);
 	}
 
 	// Need to set our movement status to what it was when we saved, or at least resetting it, so that if we load when we die, our character won't be stuck in the dead state
 	SetMovementStatus(EMovementStatus::EMS_Normal); // Should no longer be stuck in the dead status
 	GetMesh()->bPauseAnims = false;
 	GetMesh()->bNoSkeletonUpdate = false;
+}
+
+void AMain::OnSavedWeaponLoaded(FName WeaponName, TSubclassOf<AWeapon> WeaponClass)
+{
+	// Only the weapon from the most recent load, in case another load came in while this one was still loading
+	if (WeaponName != PendingWeaponName || WeaponClass == nullptr) return;
+	PendingWeaponName = NAME_None;
 
-	if (LoadGameInstance->CharacterStats.LevelName != TEXT(""))
+	AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(WeaponClass);
+	if (WeaponToEquip)
+	{
+		// Weapon class has the functionality to equip it to our character!
+		WeaponToEquip->Equip(this);
+	}
+}
+
+void AMain::SaveGame()
+{
+	// UPlayerSaveSubsystem lives on the GameInstance, so it's still around after OpenLevel and keeps our stats in memory
+	// All we do on the game thread is copy the stats, serializing and writing the file happens in the background
+	UPlayerSaveSubsystem* SaveSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UPlayerSaveSubsystem>() : nullptr;
+	if (SaveSubsystem)
+	{
+		FCharacterStats Stats;
+		GatherCharacterStats(Stats);
+		SaveSubsystem->SaveAsync(Stats);
+	}
+}
+
+void AMain::LoadGame(bool bSetPosition)
+{
+	// An explicit load always goes back to the slot on disk, and whatever we load becomes the state we carry between levels
+	UPlayerSaveSubsystem* SaveSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UPlayerSaveSubsystem>() : nullptr;
+	FCharacterStats Stats;
+	if (SaveSubsystem == nullptr || !SaveSubsystem->LoadFromDisk(Stats)) return; // Nothing saved yet
+	SaveSubsystem->SetPlayerState(Stats);
+
+	ApplyCharacterStats(Stats, bSetPosition);
+
+	// If the save is for the level we're already on there's no reload to clear out what's been consumed, so do it here
+	UWorldStateSubsystem* WorldState = GetGameInstance()->GetSubsystem<UWorldStateSubsystem>();
+	if (WorldState)
+	{
+		WorldState->ApplyToWorld(GetWorld());
+	}
+
+	if (Stats.LevelName != TEXT(""))
 	{
 		// If the game hasn't been saved, and the name of the world hasn't been loaded, we don't want to load anything
 		// However, if it's not then we can continue and switch the level
-		FName LevelName(*LoadGameInstance->CharacterStats.LevelName);
+		FName LevelName(*Stats.LevelName);
 		// SwitchLevel() takes an FString not an FName, so we have to convert it using this method, AND REMEMBER THE DEREFERENCING!
-		SwitchLevel(LevelName);
+		// The saved sublevel goes along too, otherwise the handoff would replace it with none and the new map wouldn't know to show it
+		SwitchLevel(LevelName, Stats.StreamedLevelName.IsEmpty() ? NAME_None : FName(*Stats.StreamedLevelName));
 	}
 }
 
 void AMain::LoadGameNoSwitch() // Ideal for loading the level as we switch to a new level
 {
 	// This will do all the same stuff as LoadGame, but NOT set the position
-	UFirstSaveGame* LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::CreateSaveGameObject(UFirstSaveGame::StaticClass()));
-
-	LoadGameInstance = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromSlot(LoadGameInstance->PlayerName, LoadGameInstance->UserIndex));
-
-	Health = LoadGameInstance->CharacterStats.Health;
-	MaxHealth = LoadGameInstance->CharacterStats.MaxHealth;
-	Stamina = LoadGameInstance->CharacterStats.Stamina;
-	MaxStamina = LoadGameInstance->CharacterStats.MaxStamina;
-	Coins = LoadGameInstance->CharacterStats.Coins;
-
-	if (WeaponStorage)
+	// And it doesn't need the disk either, SwitchLevel left our stats in the save subsystem before the old level went away
+	UPlayerSaveSubsystem* SaveSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UPlayerSaveSubsystem>() : nullptr;
+	FCharacterStats Stats;
+	if (SaveSubsystem && SaveSubsystem->GetPlayerState(Stats))
 	{
-		AItemStorage* Weapons = GetWorld()->SpawnActor<AItemStorage>(WeaponStorage);
-		if (Weapons)
-		{
-			FString WeaponName = LoadGameInstance->CharacterStats.WeaponName;
-
-			if (WeaponName != TEXT(""))
-			{
-				if (Weapons->WeaponMap.Contains(WeaponName))
-				{
-					AWeapon* WeaponToEquip = GetWorld()->SpawnActor<AWeapon>(Weapons->WeaponMap[WeaponName]);
-					WeaponToEquip->Equip(this);
-				}
-			}
-		}
+		ApplyCharacterStats(Stats, false);
 	}
-	SetMovementStatus(EMovementStatus::EMS_Normal); 
-	GetMesh()->bPauseAnims = false;
-	GetMesh()->bNoSkeletonUpdate = false;
 }
 
 // Another quick way to pause the entire game:
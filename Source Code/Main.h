@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "StaminaComponent.h"
 #include "Main.generated.h"
 
 // Making our own enum (and making it registered with the garbage collector)
@@ -23,16 +24,7 @@ enum class EMovementStatus : uint8 // Meant to represent if the characters sprin
 	EMS_MAX UMETA(DisplayName = "DefaultMAX") // Generally a good idea to put a MAX at the end of your enums to represent a maximum for the enum constant your working with
 };
 
-UENUM(BlueprintType)
-enum class EStaminaStatus : uint8
-{
-	ESS_Normal UMETA(DisplayName = "Normal"),
-	ESS_BelowMinimum UMETA(DisplayName = "BelowMinimum"),
-	ESS_Exhausted UMETA(DisplayName = "Exhausted"),
-	ESS_ExhaustedRecovering UMETA(DisplayName = "ExhaustedRecovering"),
-
-	ESS_MAX UMETA(DisplayName = "DefaultMAX")
-};
+// EStaminaStatus lives in StaminaComponent.h now, alongside the state machine that drives it
 
 UCLASS()
 class MYPROJECT_API AMain : public ACharacter
@@ -43,6 +35,7 @@ public:
 	// Sets default values for this character's properties
 	AMain();
 
+	// Old way of finding saved weapons. New weapons go in the UWeaponCatalog the weapon registry is set up with, this is only read as a fallback
 	UPROPERTY(EditDefaultsOnly, Category = "SavedData")
 	TSubclassOf<class AItemStorage> WeaponStorage;
 
@@ -84,6 +77,31 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
 	float MinSprintStamina;
 
+	/** Runs the stamina state machine without ticking. StaminaStatus above gets synced from it whenever the status changes */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Movement")
+	class UStaminaComponent* StaminaComponent;
+
+	/** Current stamina, worked out by the stamina component. Also what Blueprints get when they read Stamina */
+	UFUNCTION(BlueprintPure, Category = "Player Stats")
+	float GetStamina() const;
+
+	/** What Blueprints setting Stamina go through, so the stamina component starts over from the new value */
+	UFUNCTION(BlueprintSetter, Category = "Player Stats")
+	void SetStamina(float NewStamina);
+
+	void OnStaminaStatusChanged(EStaminaStatus Status);
+
+	/** Sprinting if the key is held, we're moving and stamina allows it. Only touches the movement component when that changes */
+	void UpdateSprintMovement();
+
+	/** The HUD model on our controller, or nullptr if we aren't player controlled */
+	class UMainHUDModel* GetHUDModel() const;
+
+	// Tell the HUD about changes. Called from everything that changes health, coins or the direction stamina is heading
+	void PushHealthToHUD();
+	void PushCoinsToHUD();
+	void PushStaminaToHUD();
+
 	/** Below three are for attempting to make it easier for the character to actually hit the enemy, turning him towards the enemy */
 	float InterpSpeed;
 	bool bInterpToEnemy;
@@ -147,7 +165,11 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player Stats")
 	float MaxStamina;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Stats")
+	/**
+	 * Stamina to start with, and the last value set from a save or Blueprint
+	 * Blueprints reading it go through GetStamina so the HUD bar keeps moving. C++ should call GetStamina too
+	 */
+	UPROPERTY(EditAnywhere, BlueprintGetter = GetStamina, BlueprintSetter = SetStamina, Category = "Player Stats")
 	float Stamina;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Stats")
@@ -255,10 +277,25 @@ public:
 
 	void UpdateCombatTarget();
 
+	/** Old overlap based target search, closest enemy overlapping us or nullptr */
+	AEnemy* FindClosestOverlappingEnemy();
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
 	TSubclassOf<AEnemy> EnemyFilter;
 
-	void SwitchLevel(FName LevelName); // Switch level to the specified level
+	void SwitchLevel(FName LevelName, FName StreamedLevelName = NAME_None); // Switch level to the specified level
+
+	/**
+	 * Hands our stats to the save subsystem for a level transition, and autosaves if that's turned on
+	 * Both kinds of transition go through this: SwitchLevel right before OpenLevel, and a streaming transition volume once we're in the new sublevel
+	 */
+	void HandOffForLevelTransition(FName LevelName, FName StreamedLevelName);
+
+	/** The sublevel a streaming transition last took us to, None if we haven't had one on this map. Saved so a load can show it again */
+	FName CurrentStreamedLevel;
+
+	/** Streams in a sublevel from a save, and out the one a streaming transition left us in. Blocks until it's in, since we're about to be put on it */
+	void RestoreStreamedLevel(FName StreamedLevelName);
 
 	// Put all the functionality for saving the game inside the MainCharacter since they'll have access to all their information already
 	// No need to make a child that looks up to a parent, so to speak
@@ -269,5 +306,17 @@ public:
 	void LoadGame(bool bSetPosition);
 
 	void LoadGameNoSwitch(); // Meant for when we're switching levels, not actually loading the game
+
+	/** Copies everything we save or carry between levels into Stats */
+	void GatherCharacterStats(struct FCharacterStats& OutStats) const;
+
+	/** The other way round, used by both loads */
+	void ApplyCharacterStats(const struct FCharacterStats& Stats, bool bSetPosition);
+
+	/** Equips the saved weapon once the weapon registry has its class loaded */
+	void OnSavedWeaponLoaded(FName WeaponName, TSubclassOf<AWeapon> WeaponClass);
+
+	/** Weapon the last load is waiting on, NAME_None if there isn't one */
+	FName PendingWeaponName;
 	
 };
@@ -5,45 +5,78 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Main.h"
 
+void FMainAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+    FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+    // Game thread: only read what the worker can't safely touch (the pawn and its movement component)
+    UMainAnimInstance* MainAnimInstance = CastChecked<UMainAnimInstance>(InAnimInstance);
+    if (MainAnimInstance->Pawn == nullptr)
+    {
+        MainAnimInstance->CacheOwner();
+    }
+
+    if (MainAnimInstance->Pawn)
+    {
+        Velocity = MainAnimInstance->Pawn->GetVelocity();
+        bIsFalling = MainAnimInstance->MovementComponent && MainAnimInstance->MovementComponent->IsFalling();
+    }
+    else
+    {
+        Velocity = FVector::ZeroVector;
+        bIsFalling = false;
+    }
+}
+
+void FMainAnimInstanceProxy::Update(float DeltaSeconds)
+{
+    FAnimInstanceProxy::Update(DeltaSeconds);
+
+    // Worker thread: runs right before the anim graph is updated, so the BlendSpace sees this frame's values.
+    // The game thread doesn't touch the instance while its parallel update is in flight
+    UMainAnimInstance* MainAnimInstance = CastChecked<UMainAnimInstance>(GetAnimInstanceObject());
+    MainAnimInstance->MovementSpeed = Velocity.Size2D(); // Lateral speed only, same as before
+    MainAnimInstance->bIsInAir = bIsFalling;
+}
+
 void UMainAnimInstance::NativeInitializeAnimation() 
 {
     // First things we want to do here is check to see if the pawn is null
     if (Pawn == nullptr)
     {
-        Pawn = TryGetPawnOwner(); // This will try to get the owner of this animation instance
-        // Nice function that AnimInstance inherits. Checks to see what is the pawn that owns this animation instance, if it has one, and return it if it has one...
-        // ... and store it in Pawn
-        if (Pawn)
-        {
-            Main = Cast<AMain>(Pawn);
-        }
+        CacheOwner();
     }
 
-    // Next we want some sort of function that can get called every frame, like a Tick, but Actors have a Tick, AnimInstance doesn't
-    // We want something that can update the Speed and IsInAir variables for us so that we can update what our animation is doing at any given frame
+    // Per frame updates are done by FMainAnimInstanceProxy, so the AnimBP doesn't need an event graph to call UpdateAnimationProperties
+}
 
+FAnimInstanceProxy* UMainAnimInstance::CreateAnimInstanceProxy()
+{
+    // Default DestroyAnimInstanceProxy deletes it for us
+    return new FMainAnimInstanceProxy(this);
 }
 
-void UMainAnimInstance::UpdateAnimationProperties() // Call this function every frame
+void UMainAnimInstance::CacheOwner()
+{
+    Pawn = TryGetPawnOwner(); // This will try to get the owner of this animation instance
+    // Nice function that AnimInstance inherits. Checks to see what is the pawn that owns this animation instance, if it has one, and return it if it has one...
+    // ... and store it in Pawn
+    Main = Pawn ? Cast<AMain>(Pawn) : nullptr;
+    MovementComponent = Pawn ? Pawn->GetMovementComponent() : nullptr;
+}
+
+void UMainAnimInstance::UpdateAnimationProperties() // Legacy; the proxy does this now
 {
     // First thing we need to do is check the Pawn is valid
     if (Pawn == nullptr)
     {
-        Pawn = TryGetPawnOwner(); // Just do the same thing we do above to make sure there's an owner
+        CacheOwner(); // Just do the same thing we do above to make sure there's an owner
     }
 
     if (Pawn)
     {
         // Every frame the most important thing we wanna get is the speed and whether or not the character is in the air
-        FVector Speed = Pawn->GetVelocity(); // Get from the Pawn how fast it's going at that time/frame
-        FVector LateralSpeed = FVector(Speed.X, Speed.Y, 0.f);
-        MovementSpeed = LateralSpeed.Size(); // Will give us the magnitude of that vector as a float
-
-        bIsInAir = Pawn->GetMovementComponent()->IsFalling(); // Get that information from the CharacterMovementComponent
-
-        if (Main == nullptr)
-        {
-            Main = Cast<AMain>(Pawn);
-        }
+        MovementSpeed = Pawn->GetVelocity().Size2D(); // Magnitude of the lateral velocity as a float
+        bIsInAir = MovementComponent && MovementComponent->IsFalling(); // Get that information from the CharacterMovementComponent
     }
-}
\ No newline at end of file
+}
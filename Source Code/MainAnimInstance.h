@@ -4,8 +4,36 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "MainAnimInstance.generated.h"
 
+/**
+ * Proxy for UMainAnimInstance. PreUpdate runs on the game thread and only snapshots the velocity and falling
+ * state of the owning pawn; Update runs on an animation worker thread and turns that into MovementSpeed and
+ * bIsInAir just before the anim graph is updated, so the AnimBP needs no event graph at all.
+ */
+struct FMainAnimInstanceProxy : public FAnimInstanceProxy
+{
+	FMainAnimInstanceProxy()
+		: FAnimInstanceProxy()
+	{
+	}
+
+	FMainAnimInstanceProxy(UAnimInstance* InAnimInstance)
+		: FAnimInstanceProxy(InAnimInstance)
+	{
+	}
+
+protected:
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+	virtual void Update(float DeltaSeconds) override;
+
+private:
+	// Game thread snapshot, consumed on the worker thread
+	FVector Velocity = FVector::ZeroVector;
+	bool bIsFalling = false;
+};
+
 /**
  * 
  */
@@ -17,6 +45,8 @@ public:
 	// UAnimInstance is not an actor, hence the U at the beginning, so it doesn't have a BeginPlay()
 	virtual void NativeInitializeAnimation() override; // This will be similar to BeginPlay for us
 
+	// Kept for AnimBPs whose event graph still calls this every frame. The proxy already fills in MovementSpeed and bIsInAir
+	// on the worker thread, so new AnimBPs should leave the event graph empty and let the graph run multi-threaded
 	UFUNCTION(BlueprintCallable, Category = AnimationProperties) // Can give functions a UFUNCTION tag and, just like UPROPERTY, can have them work with blueprints
 	void UpdateAnimationProperties();
 
@@ -33,4 +63,16 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Movement)
 	class AMain* Main;
 
+	// Cached once in NativeInitializeAnimation so the per-frame snapshot doesn't go through GetMovementComponent
+	UPROPERTY(Transient)
+	class UPawnMovementComponent* MovementComponent;
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+
+private:
+	/** Looks up Pawn, Main and MovementComponent from the owner every time it's called; callers only call it while Pawn is still null. */
+	void CacheOwner();
+
+	friend struct FMainAnimInstanceProxy;
 };
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MainHUDModel.h"
+#include "MyProject.h"
+
+DECLARE_CYCLE_STAT(TEXT("HUD Model Stamina"), STAT_HUDModelStamina, STATGROUP_MyProject);
+
+UMainHUDModel::UMainHUDModel()
+{
+	Health = -1.f;
+	MaxHealth = -1.f;
+	Stamina = -1.f;
+	MaxStamina = -1.f;
+	StaminaStatus = EStaminaStatus::ESS_MAX;
+	Coins = -1;
+	StaminaSource = nullptr;
+	bStaminaDirty = false;
+}
+
+TStatId UMainHUDModel::GetStatId() const
+{
+	return GET_STATID(STAT_HUDModelStamina);
+}
+
+void UMainHUDModel::SetHealth(float InHealth, float InMaxHealth)
+{
+	if (InHealth == Health && InMaxHealth == MaxHealth) return;
+
+	Health = InHealth;
+	MaxHealth = InMaxHealth;
+	OnHealthChanged.Broadcast(Health, MaxHealth);
+}
+
+void UMainHUDModel::SetCoins(int32 InCoins)
+{
+	if (InCoins == Coins) return;
+
+	Coins = InCoins;
+	OnCoinsChanged.Broadcast(Coins);
+}
+
+void UMainHUDModel::SetStaminaSource(UStaminaComponent* InStaminaComponent)
+{
+	StaminaSource = InStaminaComponent;
+	RefreshStamina();
+}
+
+void UMainHUDModel::RefreshStamina()
+{
+	bStaminaDirty = true;
+	UpdateStamina();
+}
+
+bool UMainHUDModel::IsTickable() const
+{
+	if (IsTemplate() || StaminaSource == nullptr) return false;
+
+	// Nothing to show until stamina starts moving again
+	return bStaminaDirty || StaminaSource->GetModel().GetRate() != 0.f;
+}
+
+void UMainHUDModel::Tick(float DeltaTime)
+{
+	UpdateStamina();
+}
+
+void UMainHUDModel::UpdateStamina()
+{
+	if (StaminaSource == nullptr) return;
+
+	const EStaminaStatus NewStatus = StaminaSource->GetStaminaStatus();
+	if (NewStatus != StaminaStatus)
+	{
+		StaminaStatus = NewStatus;
+		OnStaminaStatusChanged.Broadcast(StaminaStatus);
+	}
+
+	const float NewStamina = StaminaSource->GetStamina();
+	const float NewMaxStamina = StaminaSource->GetModel().MaxStamina;
+	if (NewStamina != Stamina || NewMaxStamina != MaxStamina)
+	{
+		Stamina = NewStamina;
+		MaxStamina = NewMaxStamina;
+		OnStaminaChanged.Broadcast(Stamina, MaxStamina);
+	}
+
+	bStaminaDirty = false;
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Tickable.h"
+#include "StaminaComponent.h"
+#include "MainHUDModel.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnHUDStatChanged, float, Value, float, MaxValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDCoinsChanged, int32, Coins);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHUDStaminaStatusChanged, EStaminaStatus, Status);
+
+/**
+ * Everything the player HUD shows, pushed in by AMain whenever it changes instead of the HUD reading it off the character every frame
+ * Widgets bind to the delegates and only redraw when one fires
+ */
+UCLASS(BlueprintType)
+class MYPROJECT_API UMainHUDModel : public UObject, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UMainHUDModel();
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDStatChanged OnHealthChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDStatChanged OnStaminaChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDStaminaStatusChanged OnStaminaStatusChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FOnHUDCoinsChanged OnCoinsChanged;
+
+	// Setters only broadcast when the value actually changed
+	void SetHealth(float InHealth, float InMaxHealth);
+	void SetCoins(int32 InCoins);
+
+	/**
+	 * Stamina changes smoothly while draining or recovering, so rather than have AMain push it every frame, we watch its stamina component
+	 * and only update while the stamina is actually moving
+	 */
+	void SetStaminaSource(UStaminaComponent* InStaminaComponent);
+
+	/** Call when the stamina component's status or direction changes (status change, shift pressed or released) */
+	void RefreshStamina();
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	float GetHealth() const { return Health; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	float GetMaxHealth() const { return MaxHealth; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	float GetStamina() const { return Stamina; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	float GetMaxStamina() const { return MaxStamina; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	EStaminaStatus GetStaminaStatus() const { return StaminaStatus; }
+
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	int32 GetCoins() const { return Coins; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	float Health;
+	float MaxHealth;
+	float Stamina;
+	float MaxStamina;
+	EStaminaStatus StaminaStatus;
+	int32 Coins;
+
+	UPROPERTY()
+	UStaminaComponent* StaminaSource;
+
+	/** Set when stamina needs one more update even though it isn't moving (it just stopped, or the source changed) */
+	bool bStaminaDirty;
+
+	void UpdateStamina();
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MainHUDWidget.h"
+#include "MainHUDModel.h"
+#include "Components/ProgressBar.h"
+#include "Components/TextBlock.h"
+
+void UMainHUDWidget::SetModel(UMainHUDModel* InModel)
+{
+	if (Model)
+	{
+		Model->OnHealthChanged.RemoveAll(this);
+		Model->OnStaminaChanged.RemoveAll(this);
+		Model->OnStaminaStatusChanged.RemoveAll(this);
+		Model->OnCoinsChanged.RemoveAll(this);
+	}
+
+	Model = InModel;
+	if (Model == nullptr) return;
+
+	Model->OnHealthChanged.AddDynamic(this, &UMainHUDWidget::HandleHealthChanged);
+	Model->OnStaminaChanged.AddDynamic(this, &UMainHUDWidget::HandleStaminaChanged);
+	Model->OnStaminaStatusChanged.AddDynamic(this, &UMainHUDWidget::HandleStaminaStatusChanged);
+	Model->OnCoinsChanged.AddDynamic(this, &UMainHUDWidget::HandleCoinsChanged);
+
+	// Catch up on whatever was pushed before we existed
+	HandleHealthChanged(Model->GetHealth(), Model->GetMaxHealth());
+	HandleStaminaChanged(Model->GetStamina(), Model->GetMaxStamina());
+	HandleStaminaStatusChanged(Model->GetStaminaStatus());
+	HandleCoinsChanged(Model->GetCoins());
+}
+
+void UMainHUDWidget::NativeDestruct()
+{
+	SetModel(nullptr);
+
+	Super::NativeDestruct();
+}
+
+void UMainHUDWidget::HandleHealthChanged(float Value, float MaxValue)
+{
+	if (HealthBar && MaxValue > 0.f)
+	{
+		HealthBar->SetPercent(Value / MaxValue);
+	}
+}
+
+void UMainHUDWidget::HandleStaminaChanged(float Value, float MaxValue)
+{
+	if (StaminaBar && MaxValue > 0.f)
+	{
+		StaminaBar->SetPercent(Value / MaxValue);
+	}
+}
+
+void UMainHUDWidget::HandleStaminaStatusChanged(EStaminaStatus Status)
+{
+	if (Status != EStaminaStatus::ESS_MAX)
+	{
+		StaminaStatusChanged(Status);
+	}
+}
+
+void UMainHUDWidget::HandleCoinsChanged(int32 Coins)
+{
+	if (CoinsText && Coins >= 0)
+	{
+		CoinsText->SetText(FText::AsNumber(Coins));
+	}
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "StaminaComponent.h"
+#include "MainHUDWidget.generated.h"
+
+/**
+ * Native base for the HUD overlay. Reparent the overlay Blueprint to this and name its widgets to match, then drop the property bindings
+ * Values are only set when the HUD model says they changed, so with the bars inside an Invalidation Box nothing gets repainted on quiet frames
+ */
+UCLASS()
+class MYPROJECT_API UMainHUDWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UProgressBar* HealthBar;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UProgressBar* StaminaBar;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UTextBlock* CoinsText;
+
+	/** Hook the widget up to a model. Called by the player controller when it creates us */
+	void SetModel(class UMainHUDModel* InModel);
+
+	/** For the stamina bar color, or anything else the Blueprint wants to do when the status changes */
+	UFUNCTION(BlueprintImplementableEvent, Category = "HUD")
+	void StaminaStatusChanged(EStaminaStatus Status);
+
+protected:
+	virtual void NativeDestruct() override;
+
+	UPROPERTY(Transient)
+	UMainHUDModel* Model;
+
+	UFUNCTION()
+	void HandleHealthChanged(float Value, float MaxValue);
+
+	UFUNCTION()
+	void HandleStaminaChanged(float Value, float MaxValue);
+
+	UFUNCTION()
+	void HandleStaminaStatusChanged(EStaminaStatus Status);
+
+	UFUNCTION()
+	void HandleCoinsChanged(int32 Coins);
+};
@@ -3,6 +3,36 @@
 
 #include "MainPlayerController.h"
 #include "Blueprint/UserWidget.h"
+#include "MainHUDModel.h"
+#include "MainHUDWidget.h"
+#include "EnemyHealthBarManager.h"
+#include "EnemyHealthBarWidget.h"
+
+AMainPlayerController::AMainPlayerController()
+{
+    EnemyHealthBarSize = FVector2D(150.f, 25.f); // for the size of our widget in the viewport (150x, 25y)
+    EnemyHealthBarOffset = 85.f;
+
+    MaxEnemyHealthBars = 0; // Single bar until the widget Blueprint is reparented to UEnemyHealthBarWidget
+    EnemyHealthBarRange = 2000.f;
+
+    bEnemyHealthBarVisible = false;
+    bPauseMenuVisible = false;
+
+    HUDModel = nullptr;
+    HealthBarManager = nullptr;
+    bEnemyHealthBarPlaced = false;
+}
+
+UMainHUDModel* AMainPlayerController::GetHUDModel()
+{
+    // Made on first use, AMain might push to it before our BeginPlay gets around to it
+    if (HUDModel == nullptr)
+    {
+        HUDModel = NewObject<UMainHUDModel>(this);
+    }
+    return HUDModel;
+}
 
 void AMainPlayerController::BeginPlay()
 {
@@ -18,8 +48,25 @@ void AMainPlayerController::BeginPlay()
     HUDOverlay->SetVisibility(ESlateVisibility::Visible); // Exists because in code we can call this and set it to invisible
     // So we can set the HUD to visible or invisible in code if we want
 
+    // If the overlay is built on our native HUD widget, it gets its values pushed from the model instead of polling the character
+    UMainHUDWidget* HUDWidget = Cast<UMainHUDWidget>(HUDOverlay);
+    if (HUDWidget)
+    {
+        HUDWidget->SetModel(GetHUDModel());
+    }
+
+    // With more than one bar allowed, the manager makes and owns all of them
+    // It needs each bar to know which enemy it's showing, so a plain widget Blueprint still gets the single bar
+    if (WEnemyHealthBar && MaxEnemyHealthBars > 0 && WEnemyHealthBar->IsChildOf(UEnemyHealthBarWidget::StaticClass()))
+    {
+        HealthBarManager = NewObject<UEnemyHealthBarManager>(this);
+        HealthBarManager->Range = EnemyHealthBarRange;
+        HealthBarManager->BarSize = EnemyHealthBarSize;
+        HealthBarManager->ScreenOffset = EnemyHealthBarOffset;
+        HealthBarManager->Initialize(this, WEnemyHealthBar, MaxEnemyHealthBars);
+    }
     // Check enemy health bar is valid and set in the blueprints
-    if (WEnemyHealthBar)
+    else if (WEnemyHealthBar)
     {
         EnemyHealthBar = CreateWidget<UUserWidget>(this, WEnemyHealthBar);
         if (EnemyHealthBar)
@@ -32,6 +79,7 @@ void AMainPlayerController::BeginPlay()
         // One last thing we need to call to set the alignment of the widget (How it's gonna be aligned, we want it to be flat and facing the screen)
         FVector2D Alignment(0.f, 0.f);
         EnemyHealthBar->SetAlignmentInViewport(Alignment);
+        EnemyHealthBar->SetDesiredSizeInViewport(EnemyHealthBarSize); // The size never changes, so set it once here instead of every frame
         // All should work fine, just need our Enemylocation to be updated, but that updating can happen in the Main
     }
 
@@ -50,16 +98,19 @@ void AMainPlayerController::BeginPlay()
 
 void AMainPlayerController::DisplayEnemyHealthBar()
 {
-    if (EnemyHealthBar)
+    // When the health bar manager is running there is no single EnemyHealthBar, it works out who gets a bar by itself
+    // Otherwise, only touch the widget if it's actually changing
+    if (EnemyHealthBar && !bEnemyHealthBarVisible)
     {
         bEnemyHealthBarVisible = true;
+        bEnemyHealthBarPlaced = false; // Could be a different enemy, so place it fresh
         EnemyHealthBar->SetVisibility(ESlateVisibility::Visible);
     }
 }
 
 void AMainPlayerController::RemoveEnemyHealthBar()
 {
-    if (EnemyHealthBar)
+    if (EnemyHealthBar && bEnemyHealthBarVisible)
     {
         bEnemyHealthBarVisible = false;
         EnemyHealthBar->SetVisibility(ESlateVisibility::Hidden);
@@ -70,22 +121,34 @@ void AMainPlayerController::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
 
-    if (EnemyHealthBar)
+    if (HealthBarManager)
     {
-        // Need to get our enemys location in 3d space and convert it a location on a 2d screen
-        FVector2D PositionInViewport; // a vector for the position in the screen
+        HealthBarManager->Update();
+    }
+    // Hidden health bars don't need to go anywhere
+    else if (EnemyHealthBar && bEnemyHealthBarVisible)
+    {
+        // Where it lands on screen only changes if the enemy moves or our camera does
+        FVector ViewLocation;
+        FRotator ViewRotation;
+        GetPlayerViewPoint(ViewLocation, ViewRotation);
 
-        // Call a function that will allow us to take a world location and project it to the screen
-        ProjectWorldLocationToScreen(EnemyLocation, PositionInViewport);
-        PositionInViewport.Y -= 85.f;
+        if (!bEnemyHealthBarPlaced || !EnemyLocation.Equals(LastProjectedEnemyLocation) || !ViewLocation.Equals(LastViewLocation) || !ViewRotation.Equals(LastViewRotation))
+        {
+            // Need to get our enemys location in 3d space and convert it a location on a 2d screen
+            FVector2D PositionInViewport; // a vector for the position in the screen
 
-        FVector2D SizeInViewport = FVector2D(150.f, 25.f); // for the size of our widget in the viewport (200x, 25y)
-        // Changing above values can make it bigger, for the x, or smaller
+            // Call a function that will allow us to take a world location and project it to the screen
+            ProjectWorldLocationToScreen(EnemyLocation, PositionInViewport);
+            PositionInViewport.Y -= EnemyHealthBarOffset;
 
-        EnemyHealthBar->SetPositionInViewport(PositionInViewport); // Set the location in viewport
-        EnemyHealthBar->SetDesiredSizeInViewport(SizeInViewport); // Set the size in viewport
-        // This should effectively set the size and location to the FVector EnemyLocation
-        // All we need is to get the EnemyLocation and use that to project a 2d position on the viewport
+            EnemyHealthBar->SetPositionInViewport(PositionInViewport); // Set the location in viewport
+
+            LastProjectedEnemyLocation = EnemyLocation;
+            LastViewLocation = ViewLocation;
+            LastViewRotation = ViewRotation;
+            bEnemyHealthBarPlaced = true;
+        }
     }
 }
 
@@ -63,6 +63,46 @@ public:
 
 	void GameModeOnly();
 
+	/** What the HUD shows. AMain pushes health, stamina and coins in here, and the HUD widget listens for changes */
+	UFUNCTION(BlueprintPure, Category = "HUD")
+	class UMainHUDModel* GetHUDModel();
+
+	/** Size of the enemy health bar on screen */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets")
+	FVector2D EnemyHealthBarSize;
+
+	/** How far above the projected enemy location the health bar sits */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets")
+	float EnemyHealthBarOffset;
+
+	/**
+	 * How many enemy health bars can be up at once. Above 0, the health bar manager shows bars over nearby enemies in a fight
+	 * using a pool of WEnemyHealthBar widgets. 0 goes back to the single EnemyHealthBar following our combat target
+	 * Only used when WEnemyHealthBar is a UEnemyHealthBarWidget, otherwise we stick with the single bar whatever this is set to
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets", meta = (ClampMin = "0"))
+	int32 MaxEnemyHealthBars;
+
+	/** Enemies further away than this don't get a health bar from the manager */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widgets")
+	float EnemyHealthBarRange;
+
+protected:
+	UPROPERTY(Transient)
+	UMainHUDModel* HUDModel;
+
+	UPROPERTY(Transient)
+	class UEnemyHealthBarManager* HealthBarManager;
+
+	// What the enemy health bar was last placed from. If neither the enemy nor the camera has moved, it's already in the right spot
+	FVector LastProjectedEnemyLocation;
+	FVector LastViewLocation;
+	FRotator LastViewRotation;
+	bool bEnemyHealthBarPlaced;
+
+public:
+	AMainPlayerController();
+
 private: 
 	virtual void BeginPlay() override;
 
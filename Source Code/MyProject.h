@@ -4,3 +4,5 @@
 
 #include "CoreMinimal.h"
 
+// Shared stat group for our own gameplay systems, so everything we instrument shows up together under "stat MyProject"
+DECLARE_STATS_GROUP(TEXT("MyProject"), STATGROUP_MyProject, STATCAT_Advanced);
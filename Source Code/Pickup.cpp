@@ -18,6 +18,8 @@ void APickup::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* O
     // So to do that we'll call Super
     Super::OnOverlapBegin(OverlappedComponent, OtherActor, OtherComp, OtherBodyIndex, bFromSweep, SweepResult);
 
+    if (bInPool) return; // Already consumed this frame and waiting in the item pool
+
     if (OtherActor) // Doing the same thing as in Explosive, only we're adding coins
     {
         AMain* Main = Cast<AMain>(OtherActor);
@@ -41,7 +43,7 @@ void APickup::OnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* O
                 UGameplayStatics::PlaySound2D(this, OverlapSound);
             }
 
-            Destroy();
+            Consume(); // Destroys us, or sends us back to the item pool if we're poolable
         }
     }
 
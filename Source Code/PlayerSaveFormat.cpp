@@ -0,0 +1,388 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlayerSaveFormat.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/FileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+const uint32 FPlayerSaveFormat::Magic = 0x5653504D; // "MPSV"
+
+// 1: zlib compressed FCharacterStats, tagged property serialization, 16 byte header
+// 2: fixed size header with the slot details, string table + tagged fields, optional LZ4
+const uint32 FPlayerSaveFormat::CurrentVersion = 2;
+
+static const uint32 PlayerSaveFlagLZ4 = 1 << 0;
+
+// The header isn't covered by the checksum, so the size it claims for the payload once it's decompressed has to be checked before
+// anything is allocated for it. A real save is a few hundred bytes, and neither LZ4 nor zlib can shrink anything by more than these
+static const int64 MaxUncompressedPayloadSize = 16 * 1024 * 1024;
+static const int64 MaxLZ4Ratio = 255;
+static const int64 MaxZlibRatio = 1032;
+
+/** Field ids in the payload. Never reuse or renumber one, old files still have them. 0 ends the list */
+enum class EPlayerSaveField : uint8
+{
+	End = 0,
+	Health,
+	MaxHealth,
+	Stamina,
+	MaxStamina,
+	Coins,
+	Location,
+	Rotation,
+	WeaponName,
+	LevelName,
+	StreamedLevelName,
+	UsePlayerStart,
+};
+
+/** Every distinct string in a save is written once, fields refer to it by index */
+struct FPlayerSaveNameTable
+{
+	TArray<FString> Names;
+	TMap<FString, uint32> Indices;
+
+	uint32 Intern(const FString& Name)
+	{
+		const uint32* Existing = Indices.Find(Name);
+		if (Existing) return *Existing;
+
+		const uint32 Index = Names.Add(Name);
+		Indices.Add(Name, Index);
+		return Index;
+	}
+};
+
+template <typename FuncType>
+static void WriteField(FArchive& Ar, EPlayerSaveField Field, FuncType&& WriteValue)
+{
+	TArray<uint8> Value;
+	FMemoryWriter ValueWriter(Value);
+	WriteValue(ValueWriter);
+
+	uint8 FieldId = (uint8)Field;
+	uint32 ValueSize = Value.Num();
+	Ar << FieldId;
+	Ar.SerializeIntPacked(ValueSize);
+	Ar.Serialize(Value.GetData(), ValueSize);
+}
+
+bool FPlayerSaveHeader::IsCompressed() const
+{
+	return (Flags & PlayerSaveFlagLZ4) != 0;
+}
+
+bool FPlayerSaveFormat::Write(const FCharacterStats& Stats, float PlayTimeSeconds, int64 Timestamp, bool bCompress, TArray<uint8>& OutFile)
+{
+	FPlayerSaveNameTable Names;
+
+	TArray<uint8> Fields;
+	FMemoryWriter FieldWriter(Fields);
+	WriteField(FieldWriter, EPlayerSaveField::Health, [&](FArchive& Ar) { float Value = Stats.Health; Ar << Value; });
+	WriteField(FieldWriter, EPlayerSaveField::MaxHealth, [&](FArchive& Ar) { float Value = Stats.MaxHealth; Ar << Value; });
+	WriteField(FieldWriter, EPlayerSaveField::Stamina, [&](FArchive& Ar) { float Value = Stats.Stamina; Ar << Value; });
+	WriteField(FieldWriter, EPlayerSaveField::MaxStamina, [&](FArchive& Ar) { float Value = Stats.MaxStamina; Ar << Value; });
+	WriteField(FieldWriter, EPlayerSaveField::Coins, [&](FArchive& Ar)
+	{
+		// Zigzag so small negative numbers stay small too
+		uint32 Value = ((uint32)Stats.Coins << 1) ^ (uint32)(Stats.Coins >> 31);
+		Ar.SerializeIntPacked(Value);
+	});
+	WriteField(FieldWriter, EPlayerSaveField::Location, [&](FArchive& Ar) { FVector Value = Stats.Location; Ar << Value; });
+	WriteField(FieldWriter, EPlayerSaveField::Rotation, [&](FArchive& Ar) { FRotator Value = Stats.Rotation; Ar << Value; });
+	WriteField(FieldWriter, EPlayerSaveField::WeaponName, [&](FArchive& Ar) { uint32 Index = Names.Intern(Stats.WeaponName); Ar.SerializeIntPacked(Index); });
+	WriteField(FieldWriter, EPlayerSaveField::LevelName, [&](FArchive& Ar) { uint32 Index = Names.Intern(Stats.LevelName); Ar.SerializeIntPacked(Index); });
+	WriteField(FieldWriter, EPlayerSaveField::StreamedLevelName, [&](FArchive& Ar) { uint32 Index = Names.Intern(Stats.StreamedLevelName); Ar.SerializeIntPacked(Index); });
+	WriteField(FieldWriter, EPlayerSaveField::UsePlayerStart, [&](FArchive& Ar) { uint8 Value = Stats.bUsePlayerStart ? 1 : 0; Ar << Value; });
+	uint8 End = (uint8)EPlayerSaveField::End;
+	FieldWriter << End;
+
+	// String table first so the fields can be resolved as they're read
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+	uint32 NumNames = Names.Names.Num();
+	PayloadWriter.SerializeIntPacked(NumNames);
+	for (const FString& Name : Names.Names)
+	{
+		FTCHARToUTF8 Utf8(*Name);
+		uint32 Length = Utf8.Length();
+		PayloadWriter.SerializeIntPacked(Length);
+		PayloadWriter.Serialize((void*)Utf8.Get(), Length);
+	}
+	PayloadWriter.Serialize(Fields.GetData(), Fields.Num());
+
+	FPlayerSaveHeader Header;
+	Header.Magic = Magic;
+	Header.Version = CurrentVersion;
+	Header.Timestamp = Timestamp;
+	Header.PlayTimeSeconds = PlayTimeSeconds;
+	Header.UncompressedSize = Payload.Num();
+	Header.LevelName = Stats.LevelName;
+
+	TArray<uint8> Stored;
+	if (bCompress)
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Payload.Num());
+		Stored.SetNumUninitialized(CompressedSize);
+		// Only worth keeping if it actually came out smaller
+		if (FCompression::CompressMemory(NAME_LZ4, Stored.GetData(), CompressedSize, Payload.GetData(), Payload.Num()) && CompressedSize < Payload.Num())
+		{
+			Stored.SetNum(CompressedSize, false);
+			Header.Flags |= PlayerSaveFlagLZ4;
+		}
+	}
+	if (!Header.IsCompressed())
+	{
+		Stored = MoveTemp(Payload);
+	}
+
+	Header.PayloadSize = Stored.Num();
+	Header.Checksum = FCrc::MemCrc32(Stored.GetData(), Stored.Num());
+
+	OutFile.Reset(FPlayerSaveHeader::Size + Stored.Num());
+	FMemoryWriter FileWriter(OutFile);
+	FileWriter << Header.Magic << Header.Version << Header.Flags << Header.Checksum << Header.Timestamp << Header.PlayTimeSeconds << Header.PayloadSize << Header.UncompressedSize;
+
+	// Level name padded out to its fixed width, which keeps the header the same size for every save
+	uint8 LevelNameBytes[FPlayerSaveHeader::MaxLevelNameBytes];
+	FMemory::Memzero(LevelNameBytes, sizeof(LevelNameBytes));
+	FTCHARToUTF8 LevelNameUtf8(*Header.LevelName);
+	FMemory::Memcpy(LevelNameBytes, LevelNameUtf8.Get(), FMath::Min<int32>(LevelNameUtf8.Length(), FPlayerSaveHeader::MaxLevelNameBytes - 1));
+	FileWriter.Serialize(LevelNameBytes, sizeof(LevelNameBytes));
+
+	check(OutFile.Num() == FPlayerSaveHeader::Size);
+	OutFile.Append(Stored);
+	return true;
+}
+
+bool FPlayerSaveFormat::ParseHeader(const uint8* Data, int64 DataSize, FPlayerSaveHeader& OutHeader)
+{
+	if (Data == nullptr || DataSize < 16) return false;
+
+	TArray<uint8> Bytes(Data, FMath::Min<int64>(DataSize, FPlayerSaveHeader::Size));
+	FMemoryReader Reader(Bytes);
+
+	FPlayerSaveHeader Header;
+	Reader << Header.Magic << Header.Version;
+	if (Header.Magic != Magic) return false;
+
+	if (Header.Version == 1)
+	{
+		// Version 1 only had the payload sizes. No level, time or checksum to show
+		int32 UncompressedSize = 0;
+		int32 CompressedSize = 0;
+		Reader << UncompressedSize << CompressedSize;
+		Header.UncompressedSize = UncompressedSize;
+		Header.PayloadSize = CompressedSize;
+		OutHeader = Header;
+		return true;
+	}
+
+	if (Bytes.Num() < FPlayerSaveHeader::Size) return false;
+
+	Reader << Header.Flags << Header.Checksum << Header.Timestamp << Header.PlayTimeSeconds << Header.PayloadSize << Header.UncompressedSize;
+
+	ANSICHAR LevelNameBytes[FPlayerSaveHeader::MaxLevelNameBytes];
+	Reader.Serialize(LevelNameBytes, sizeof(LevelNameBytes));
+	LevelNameBytes[FPlayerSaveHeader::MaxLevelNameBytes - 1] = 0;
+	Header.LevelName = UTF8_TO_TCHAR(LevelNameBytes);
+
+	OutHeader = Header;
+	return !Reader.IsError();
+}
+
+bool FPlayerSaveFormat::ReadHeader(const FString& Path, FPlayerSaveHeader& OutHeader)
+{
+	// Map just the header, the payload never gets paged in
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Path));
+	if (MappedFile)
+	{
+		const int64 MapSize = FMath::Min<int64>(MappedFile->GetFileSize(), FPlayerSaveHeader::Size);
+		TUniquePtr<IMappedFileRegion> Region(MapSize > 0 ? MappedFile->MapRegion(0, MapSize) : nullptr);
+		return Region && ParseHeader(Region->GetMappedPtr(), Region->GetMappedSize(), OutHeader);
+	}
+
+	// No memory mapping on this platform, read the first few bytes instead
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path, FILEREAD_Silent));
+	if (Reader == nullptr) return false;
+
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(FMath::Min<int64>(Reader->TotalSize(), FPlayerSaveHeader::Size));
+	Reader->Serialize(Bytes.GetData(), Bytes.Num());
+	return !Reader->IsError() && ParseHeader(Bytes.GetData(), Bytes.Num(), OutHeader);
+}
+
+bool FPlayerSaveFormat::Read(const TArray<uint8>& File, FCharacterStats& OutStats, FPlayerSaveHeader& OutHeader)
+{
+	if (!ParseHeader(File.GetData(), File.Num(), OutHeader))
+	{
+		// Written by SaveGameToSlot before we had our own format
+		OutHeader = FPlayerSaveHeader();
+		return ReadSaveGameObject(File, OutStats);
+	}
+
+	if (OutHeader.Version == 1)
+	{
+		return ReadVersion1(File, OutStats);
+	}
+
+	// Unknown fields are fine, a newer version number means something we do know changed meaning
+	if (OutHeader.Version > CurrentVersion) return false;
+
+	if ((int64)FPlayerSaveHeader::Size + OutHeader.PayloadSize > File.Num()) return false;
+
+	const uint8* Stored = File.GetData() + FPlayerSaveHeader::Size;
+	if (FCrc::MemCrc32(Stored, OutHeader.PayloadSize) != OutHeader.Checksum) return false;
+
+	TArray<uint8> Payload;
+	if (OutHeader.IsCompressed())
+	{
+		if (OutHeader.UncompressedSize > MaxUncompressedPayloadSize || OutHeader.UncompressedSize > (int64)OutHeader.PayloadSize * MaxLZ4Ratio)
+		{
+			return false;
+		}
+
+		Payload.SetNumUninitialized(OutHeader.UncompressedSize);
+		if (!FCompression::UncompressMemory(NAME_LZ4, Payload.GetData(), Payload.Num(), Stored, OutHeader.PayloadSize))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		Payload.Append(Stored, OutHeader.PayloadSize);
+	}
+
+	return ReadPayload(Payload, OutStats);
+}
+
+bool FPlayerSaveFormat::ReadPayload(const TArray<uint8>& Payload, FCharacterStats& OutStats)
+{
+	FMemoryReader Reader(Payload);
+
+	uint32 NumNames = 0;
+	Reader.SerializeIntPacked(NumNames);
+	if (NumNames > (uint32)Payload.Num()) return false; // Every name takes at least a byte, anything bigger is garbage
+
+	TArray<FString> Names;
+	Names.Reserve(NumNames);
+	for (uint32 i = 0; i < NumNames && !Reader.IsError(); i++)
+	{
+		uint32 Length = 0;
+		Reader.SerializeIntPacked(Length);
+		if (Reader.Tell() + Length > Payload.Num()) return false;
+
+		FUTF8ToTCHAR Name((const ANSICHAR*)Payload.GetData() + Reader.Tell(), Length);
+		Names.Add(FString(Name.Length(), Name.Get()));
+		Reader.Seek(Reader.Tell() + Length);
+	}
+
+	auto ReadName = [&](FString& OutName)
+	{
+		uint32 Index = 0;
+		Reader.SerializeIntPacked(Index);
+		OutName = Names.IsValidIndex(Index) ? Names[Index] : FString();
+	};
+
+	// Anything a field doesn't set stays at zero, same as a fresh FCharacterStats would be
+	FCharacterStats Stats = FCharacterStats();
+	while (!Reader.IsError() && !Reader.AtEnd())
+	{
+		uint8 FieldId = 0;
+		Reader << FieldId;
+		if ((EPlayerSaveField)FieldId == EPlayerSaveField::End) break;
+
+		uint32 ValueSize = 0;
+		Reader.SerializeIntPacked(ValueSize);
+		const int64 ValueEnd = Reader.Tell() + ValueSize;
+		if (ValueEnd > Payload.Num()) return false;
+
+		switch ((EPlayerSaveField)FieldId)
+		{
+		case EPlayerSaveField::Health: Reader << Stats.Health; break;
+		case EPlayerSaveField::MaxHealth: Reader << Stats.MaxHealth; break;
+		case EPlayerSaveField::Stamina: Reader << Stats.Stamina; break;
+		case EPlayerSaveField::MaxStamina: Reader << Stats.MaxStamina; break;
+		case EPlayerSaveField::Coins:
+		{
+			uint32 Value = 0;
+			Reader.SerializeIntPacked(Value);
+			Stats.Coins = (int32)(Value >> 1) ^ -(int32)(Value & 1);
+			break;
+		}
+		case EPlayerSaveField::Location: Reader << Stats.Location; break;
+		case EPlayerSaveField::Rotation: Reader << Stats.Rotation; break;
+		case EPlayerSaveField::WeaponName: ReadName(Stats.WeaponName); break;
+		case EPlayerSaveField::LevelName: ReadName(Stats.LevelName); break;
+		case EPlayerSaveField::StreamedLevelName: ReadName(Stats.StreamedLevelName); break;
+		case EPlayerSaveField::UsePlayerStart:
+		{
+			uint8 Value = 0;
+			Reader << Value;
+			Stats.bUsePlayerStart = Value != 0;
+			break;
+		}
+		default: break; // From a newer build, skip it
+		}
+
+		// Always continue from where the field says it ends, so a field that grew in a later version doesn't throw the rest off
+		Reader.Seek(ValueEnd);
+	}
+
+	if (Reader.IsError()) return false;
+
+	OutStats = Stats;
+	return true;
+}
+
+bool FPlayerSaveFormat::ReadVersion1(const TArray<uint8>& File, FCharacterStats& OutStats)
+{
+	FMemoryReader FileReader(File, true);
+	uint32 FileMagic = 0;
+	int32 Version = 0;
+	int32 UncompressedSize = 0;
+	int32 CompressedSize = 0;
+	FileReader << FileMagic << Version << UncompressedSize << CompressedSize;
+
+	if (CompressedSize < 0 || UncompressedSize < 0 || FileReader.Tell() + CompressedSize > File.Num()
+		|| UncompressedSize > MaxUncompressedPayloadSize || UncompressedSize > (int64)CompressedSize * MaxZlibRatio)
+	{
+		return false;
+	}
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(NAME_Zlib, Payload.GetData(), UncompressedSize, File.GetData() + FileReader.Tell(), CompressedSize))
+	{
+		return false;
+	}
+
+	FMemoryReader PayloadReader(Payload, true);
+	FObjectAndNameAsStringProxyArchive PayloadArchive(PayloadReader, true);
+	FCharacterStats Loaded = FCharacterStats();
+	FCharacterStats::StaticStruct()->SerializeItem(PayloadArchive, &Loaded, nullptr);
+	if (PayloadReader.IsError()) return false;
+
+	OutStats = Loaded;
+	return true;
+}
+
+bool FPlayerSaveFormat::ReadSaveGameObject(const TArray<uint8>& File, FCharacterStats& OutStats)
+{
+	// Creates a UObject, so this one has to be on the game thread
+	check(IsInGameThread());
+
+	UFirstSaveGame* LegacySave = Cast<UFirstSaveGame>(UGameplayStatics::LoadGameFromMemory(File));
+	if (LegacySave == nullptr) return false;
+
+	OutStats = LegacySave->CharacterStats;
+	return true;
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FirstSaveGame.h"
+
+/**
+ * Fixed size block at the start of every save file. Everything a load game menu shows is in here,
+ * so slots can be listed without touching the payload
+ */
+struct MYPROJECT_API FPlayerSaveHeader
+{
+	/** Bytes the header takes up on disk, whatever the version */
+	static const int32 Size = 96;
+
+	/** Longest level name the header holds, in UTF-8 bytes. Longer names are cut short here but kept in full in the payload */
+	static const int32 MaxLevelNameBytes = 60;
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint32 Flags = 0;
+	uint32 Checksum = 0; // CRC32 of the payload bytes as they are on disk
+	int64 Timestamp = 0; // UTC FDateTime ticks
+	float PlayTimeSeconds = 0.f;
+	uint32 PayloadSize = 0;
+	uint32 UncompressedSize = 0;
+	FString LevelName;
+
+	bool IsCompressed() const;
+};
+
+/**
+ * Reads and writes our save files
+ *
+ * After the header comes the payload: a table of every string the save uses, then one tagged field after another.
+ * Fields are an id, a size and the data, with strings stored as indices into the table. A reader skips ids it doesn't know,
+ * so adding fields doesn't need a version bump; Version only goes up when something existing changes meaning, and Read
+ * migrates anything older up to the current layout
+ */
+struct MYPROJECT_API FPlayerSaveFormat
+{
+	static const uint32 Magic;
+	static const uint32 CurrentVersion;
+
+	/** Builds a whole file. Plain data only, so it's fine to call from a worker thread */
+	static bool Write(const FCharacterStats& Stats, float PlayTimeSeconds, int64 Timestamp, bool bCompress, TArray<uint8>& OutFile);
+
+	/** Parses a whole file of any version we've ever written, plus plain SaveGameToSlot files */
+	static bool Read(const TArray<uint8>& File, FCharacterStats& OutStats, FPlayerSaveHeader& OutHeader);
+
+	/** Reads only the header of a file on disk, through a memory mapping where the platform has one */
+	static bool ReadHeader(const FString& Path, FPlayerSaveHeader& OutHeader);
+
+private:
+	static bool ParseHeader(const uint8* Data, int64 DataSize, FPlayerSaveHeader& OutHeader);
+	static bool ReadPayload(const TArray<uint8>& Payload, FCharacterStats& OutStats);
+
+	// Older layouts, migrated to FCharacterStats as they're read
+	static bool ReadVersion1(const TArray<uint8>& File, FCharacterStats& OutStats);
+	static bool ReadSaveGameObject(const TArray<uint8>& File, FCharacterStats& OutStats);
+};
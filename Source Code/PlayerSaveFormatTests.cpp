@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "PlayerSaveFormat.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Where the v2 header keeps the numbers these tests rewrite, see FPlayerSaveFormat::Write
+static const int32 HeaderChecksumOffset = 12;
+static const int32 HeaderPayloadSizeOffset = 28;
+static const int32 HeaderUncompressedSizeOffset = 32;
+
+// Field ids never change once they've shipped, so the tests can use them as numbers
+static const uint8 HealthFieldId = 1;
+static const uint8 EndFieldId = 0;
+
+// Long and repetitive names, so LZ4 has something to work with and the compressed file really is compressed
+static FCharacterStats MakeTestStats()
+{
+	FCharacterStats Stats;
+	Stats.Health = 42.5f;
+	Stats.MaxHealth = 100.f;
+	Stats.Stamina = 75.f;
+	Stats.MaxStamina = 150.f;
+	Stats.Coins = -17;
+	Stats.Location = FVector(100.f, -250.5f, 32.f);
+	Stats.Rotation = FRotator(0.f, 90.f, 0.f);
+	Stats.WeaponName = FString::ChrN(120, TEXT('W'));
+	Stats.LevelName = FString::ChrN(120, TEXT('L'));
+	Stats.StreamedLevelName = Stats.LevelName + TEXT("_Streamed");
+	Stats.bUsePlayerStart = true;
+	return Stats;
+}
+
+static void SetHeaderValue(TArray<uint8>& File, int32 Offset, uint32 Value)
+{
+	FMemory::Memcpy(File.GetData() + Offset, &Value, sizeof(Value));
+}
+
+// Swaps in a new uncompressed payload and fixes up the header to match, as if Write had produced it
+static void ReplacePayload(TArray<uint8>& File, const TArray<uint8>& Payload)
+{
+	File.SetNum(FPlayerSaveHeader::Size);
+	File.Append(Payload);
+	SetHeaderValue(File, HeaderPayloadSizeOffset, Payload.Num());
+	SetHeaderValue(File, HeaderUncompressedSizeOffset, Payload.Num());
+	SetHeaderValue(File, HeaderChecksumOffset, FCrc::MemCrc32(Payload.GetData(), Payload.Num()));
+}
+
+// Write and Read back, with and without LZ4
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerSaveFormatRoundTripTest, "MyProject.SaveFormat.RoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FPlayerSaveFormatRoundTripTest::RunTest(const FString& Parameters)
+{
+	const FCharacterStats Stats = MakeTestStats();
+	const int64 Timestamp = FDateTime(2024, 3, 1, 12, 30).GetTicks();
+
+	for (bool bCompress : { false, true })
+	{
+		const FString Label = bCompress ? TEXT("LZ4") : TEXT("Uncompressed");
+
+		TArray<uint8> File;
+		TestTrue(Label + TEXT(" written"), FPlayerSaveFormat::Write(Stats, 3600.f, Timestamp, bCompress, File));
+
+		FCharacterStats Loaded;
+		FPlayerSaveHeader Header;
+		if (!TestTrue(Label + TEXT(" read back"), FPlayerSaveFormat::Read(File, Loaded, Header))) continue;
+
+		TestEqual(Label + TEXT(" compression flag"), Header.IsCompressed(), bCompress);
+		TestTrue(Label + TEXT(" version"), Header.Version == FPlayerSaveFormat::CurrentVersion);
+		TestEqual(Label + TEXT(" timestamp"), Header.Timestamp, Timestamp);
+		TestEqual(Label + TEXT(" play time"), Header.PlayTimeSeconds, 3600.f);
+		TestEqual(Label + TEXT(" header level name"), Header.LevelName, Stats.LevelName);
+
+		TestEqual(Label + TEXT(" health"), Loaded.Health, Stats.Health);
+		TestEqual(Label + TEXT(" max health"), Loaded.MaxHealth, Stats.MaxHealth);
+		TestEqual(Label + TEXT(" stamina"), Loaded.Stamina, Stats.Stamina);
+		TestEqual(Label + TEXT(" max stamina"), Loaded.MaxStamina, Stats.MaxStamina);
+		TestEqual(Label + TEXT(" coins"), Loaded.Coins, Stats.Coins);
+		TestEqual(Label + TEXT(" location"), Loaded.Location, Stats.Location);
+		TestEqual(Label + TEXT(" rotation"), Loaded.Rotation, Stats.Rotation);
+		TestEqual(Label + TEXT(" weapon"), Loaded.WeaponName, Stats.WeaponName);
+		TestEqual(Label + TEXT(" level"), Loaded.LevelName, Stats.LevelName);
+		TestEqual(Label + TEXT(" streamed level"), Loaded.StreamedLevelName, Stats.StreamedLevelName);
+		TestEqual(Label + TEXT(" use player start"), Loaded.bUsePlayerStart, Stats.bUsePlayerStart);
+	}
+
+	return true;
+}
+
+// A file from a newer build: a field we've never heard of, and a known field that grew
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerSaveFormatUnknownFieldsTest, "MyProject.SaveFormat.UnknownFields",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FPlayerSaveFormatUnknownFieldsTest::RunTest(const FString& Parameters)
+{
+	const FCharacterStats Stats = MakeTestStats();
+
+	TArray<uint8> File;
+	FPlayerSaveFormat::Write(Stats, 0.f, 0, false, File);
+
+	// Drop the end marker and add the new fields after everything Write put there
+	TArray<uint8> Payload(File.GetData() + FPlayerSaveHeader::Size, File.Num() - FPlayerSaveHeader::Size - 1);
+	FMemoryWriter Writer(Payload, false, true);
+
+	uint8 UnknownId = 200;
+	uint32 UnknownSize = 5;
+	uint8 UnknownValue[5] = { 1, 2, 3, 4, 5 };
+	Writer << UnknownId;
+	Writer.SerializeIntPacked(UnknownSize);
+	Writer.Serialize(UnknownValue, sizeof(UnknownValue));
+
+	// Health with four more bytes after the float a newer build might have added
+	uint8 HealthId = HealthFieldId;
+	uint32 HealthSize = sizeof(float) + 4;
+	float NewHealth = 12.f;
+	uint32 Extra = 0xDEADBEEF;
+	Writer << HealthId;
+	Writer.SerializeIntPacked(HealthSize);
+	Writer << NewHealth << Extra;
+
+	uint8 End = EndFieldId;
+	Writer << End;
+	ReplacePayload(File, Payload);
+
+	FCharacterStats Loaded;
+	FPlayerSaveHeader Header;
+	if (!TestTrue(TEXT("Read with fields it doesn't know"), FPlayerSaveFormat::Read(File, Loaded, Header))) return true;
+
+	TestEqual(TEXT("Grown field read up to what we know"), Loaded.Health, NewHealth);
+	TestEqual(TEXT("Fields before the unknown one intact"), Loaded.Coins, Stats.Coins);
+	TestEqual(TEXT("Names intact"), Loaded.WeaponName, Stats.WeaponName);
+	TestEqual(TEXT("Fields after the unknown one still read"), Loaded.bUsePlayerStart, Stats.bUsePlayerStart);
+
+	return true;
+}
+
+// Cut short, flipped bits, and headers that claim more than the file has
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerSaveFormatCorruptTest, "MyProject.SaveFormat.Corrupt",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FPlayerSaveFormatCorruptTest::RunTest(const FString& Parameters)
+{
+	const FCharacterStats Stats = MakeTestStats();
+	FCharacterStats Loaded;
+	FPlayerSaveHeader Header;
+
+	for (bool bCompress : { false, true })
+	{
+		const FString Label = bCompress ? TEXT("LZ4") : TEXT("Uncompressed");
+
+		TArray<uint8> File;
+		FPlayerSaveFormat::Write(Stats, 0.f, 0, bCompress, File);
+
+		TArray<uint8> Truncated = File;
+		Truncated.SetNum(File.Num() - 1);
+		TestFalse(Label + TEXT(" truncated payload"), FPlayerSaveFormat::Read(Truncated, Loaded, Header));
+
+		TArray<uint8> HeaderOnly = File;
+		HeaderOnly.SetNum(FPlayerSaveHeader::Size - 1);
+		TestFalse(Label + TEXT(" truncated header"), FPlayerSaveFormat::Read(HeaderOnly, Loaded, Header));
+
+		TArray<uint8> Corrupted = File;
+		Corrupted[FPlayerSaveHeader::Size + (File.Num() - FPlayerSaveHeader::Size) / 2] ^= 0x10;
+		TestFalse(Label + TEXT(" corrupted payload"), FPlayerSaveFormat::Read(Corrupted, Loaded, Header));
+
+		TArray<uint8> HugePayload = File;
+		SetHeaderValue(HugePayload, HeaderPayloadSizeOffset, MAX_uint32);
+		TestFalse(Label + TEXT(" payload size past the end of the file"), FPlayerSaveFormat::Read(HugePayload, Loaded, Header));
+
+		// The header isn't checksummed, so this must be turned away before anything gets allocated for it
+		if (bCompress)
+		{
+			TArray<uint8> HugeUncompressed = File;
+			SetHeaderValue(HugeUncompressed, HeaderUncompressedSizeOffset, MAX_uint32);
+			TestFalse(Label + TEXT(" huge uncompressed size"), FPlayerSaveFormat::Read(HugeUncompressed, Loaded, Header));
+		}
+	}
+
+	return true;
+}
+
+// ReadHeader goes to disk, so this writes a whole file and a cut short one to the transient directory
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerSaveFormatReadHeaderTest, "MyProject.SaveFormat.ReadHeader",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FPlayerSaveFormatReadHeaderTest::RunTest(const FString& Parameters)
+{
+	const FCharacterStats Stats = MakeTestStats();
+	TArray<uint8> File;
+	FPlayerSaveFormat::Write(Stats, 60.f, 0, true, File);
+
+	const FString FullPath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("SaveFormatTest.sav"));
+	const FString ShortPath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("SaveFormatTestShort.sav"));
+
+	FPlayerSaveHeader Header;
+	if (TestTrue(TEXT("Whole file written"), FFileHelper::SaveArrayToFile(File, *FullPath)))
+	{
+		TestTrue(TEXT("Header of a whole file"), FPlayerSaveFormat::ReadHeader(FullPath, Header));
+		TestEqual(TEXT("Play time"), Header.PlayTimeSeconds, 60.f);
+
+		// Only as much of the name as fits, the payload has the rest
+		TestEqual(TEXT("Level name cut to fit"), Header.LevelName, Stats.LevelName.Left(FPlayerSaveHeader::MaxLevelNameBytes - 1));
+	}
+
+	for (int32 Length : { 0, 10, FPlayerSaveHeader::Size / 2, FPlayerSaveHeader::Size - 1 })
+	{
+		TArray<uint8> Short(File.GetData(), Length);
+		if (TestTrue(TEXT("Short file written"), FFileHelper::SaveArrayToFile(Short, *ShortPath)))
+		{
+			TestFalse(FString::Printf(TEXT("Header of a %d byte file"), Length), FPlayerSaveFormat::ReadHeader(ShortPath, Header));
+		}
+	}
+
+	TestFalse(TEXT("Header of a missing file"), FPlayerSaveFormat::ReadHeader(FullPath + TEXT(".missing"), Header));
+
+	IFileManager::Get().Delete(*FullPath, false, false, true);
+	IFileManager::Get().Delete(*ShortPath, false, false, true);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
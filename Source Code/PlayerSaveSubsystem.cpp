@@ -0,0 +1,336 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlayerSaveSubsystem.h"
+#include "MyProject.h"
+#include "PlayerSaveFormat.h"
+#include "WorldStateSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Player Save Snapshot"), STAT_PlayerSaveSnapshot, STATGROUP_MyProject);
+DECLARE_CYCLE_STAT(TEXT("Player Load From Disk"), STAT_PlayerLoadFromDisk, STATGROUP_MyProject);
+DECLARE_CYCLE_STAT(TEXT("Player Save List Slots"), STAT_PlayerSaveListSlots, STATGROUP_MyProject);
+
+UPlayerSaveSubsystem::UPlayerSaveSubsystem()
+{
+	SlotName = TEXT("Default");
+	bAutosaveOnLevelTransition = true;
+	bCompressSaves = true;
+
+	bHasPlayerState = false;
+	bSavePending = false;
+	bSaveInFlight = false;
+
+	LoadedPlayTimeSeconds = 0.f;
+	PlayTimeStart = 0.0;
+}
+
+void UPlayerSaveSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PlayTimeStart = FPlatformTime::Seconds();
+}
+
+void UPlayerSaveSubsystem::Deinitialize()
+{
+	// Don't lose the last save on quit
+	FlushSaves();
+
+	Super::Deinitialize();
+}
+
+void UPlayerSaveSubsystem::FlushSaves()
+{
+	// Let the one being written finish, and write anything still queued right here
+	if (SaveTask.IsValid())
+	{
+		SaveTask.Wait();
+	}
+	if (bSavePending)
+	{
+		// Cleared first, so the FinishSave still on its way from the worker doesn't start another write of it
+		bSavePending = false;
+		WriteSaveFile(PendingSave, GetPlayTimeSeconds(), FDateTime::UtcNow().GetTicks(), bCompressSaves, GetSlotPath());
+
+		TArray<uint8> WorldRecord;
+		bool bWorldRecordFull = false;
+		if (TakeWorldRecord(WorldRecord, bWorldRecordFull))
+		{
+			UWorldStateSubsystem::WriteRecord(GetWorldStatePath(), WorldRecord, bWorldRecordFull);
+		}
+	}
+}
+
+void UPlayerSaveSubsystem::SetPlayerState(const FCharacterStats& Stats)
+{
+	PlayerState = Stats;
+	bHasPlayerState = true;
+}
+
+bool UPlayerSaveSubsystem::GetPlayerState(FCharacterStats& OutStats)
+{
+	if (!bHasPlayerState)
+	{
+		// Started straight on this level (or in PIE), so there's nothing carried over yet. Same as before, the slot is all we've got
+		FCharacterStats Loaded;
+		if (!LoadFromDisk(Loaded)) return false;
+
+		SetPlayerState(Loaded);
+	}
+
+	OutStats = PlayerState;
+	return true;
+}
+
+void UPlayerSaveSubsystem::SaveAsync(const FCharacterStats& Stats)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PlayerSaveSnapshot);
+
+	SetPlayerState(Stats);
+
+	// Only ever one write in flight. A newer save just replaces whatever was waiting, the worker picks it up when it's done
+	PendingSave = Stats;
+	bSavePending = true;
+
+	if (!bSaveInFlight)
+	{
+		StartSave();
+	}
+}
+
+void UPlayerSaveSubsystem::StartSave()
+{
+	bSaveInFlight = true;
+	bSavePending = false;
+
+	// The worker gets its own copies, nothing it touches belongs to the game thread
+	const FCharacterStats Stats = PendingSave;
+	const float PlayTimeSeconds = GetPlayTimeSeconds();
+	const int64 Timestamp = FDateTime::UtcNow().GetTicks();
+	const bool bCompress = bCompressSaves;
+	const FString Path = GetSlotPath();
+	TWeakObjectPtr<UPlayerSaveSubsystem> WeakThis(this);
+
+	// World state goes in a file of its own next to the slot, usually as a small record of what changed since the last save
+	TArray<uint8> WorldRecord;
+	bool bWorldRecordFull = false;
+	TakeWorldRecord(WorldRecord, bWorldRecordFull);
+	const FString WorldStatePath = GetWorldStatePath();
+
+	SaveTask = Async(EAsyncExecution::ThreadPool, [Stats, PlayTimeSeconds, Timestamp, bCompress, Path, WorldRecord, bWorldRecordFull, WorldStatePath, WeakThis]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const bool bSuccess = WriteSaveFile(Stats, PlayTimeSeconds, Timestamp, bCompress, Path);
+		const bool bWorldStateWritten = WorldRecord.Num() == 0 || UWorldStateSubsystem::WriteRecord(WorldStatePath, WorldRecord, bWorldRecordFull);
+		const float SaveTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bSuccess, bWorldStateWritten, SaveTimeMs]()
+		{
+			UPlayerSaveSubsystem* Subsystem = WeakThis.Get();
+			if (Subsystem)
+			{
+				Subsystem->FinishSave(bSuccess && bWorldStateWritten, bWorldStateWritten, SaveTimeMs);
+			}
+		});
+	});
+}
+
+bool UPlayerSaveSubsystem::TakeWorldRecord(TArray<uint8>& OutRecord, bool& bOutFull)
+{
+	UWorldStateSubsystem* WorldState = GetGameInstance()->GetSubsystem<UWorldStateSubsystem>();
+	if (WorldState == nullptr) return false;
+
+	// Deltas only make sense on top of the file they came from
+	if (WorldStateSlotName != SlotName)
+	{
+		WorldState->MarkAllDirty();
+		WorldStateSlotName = SlotName;
+	}
+	return WorldState->TakeRecord(OutRecord, bOutFull);
+}
+
+void UPlayerSaveSubsystem::FinishSave(bool bSuccess, bool bWorldStateWritten, float SaveTimeMs)
+{
+	bSaveInFlight = false;
+
+	if (!bWorldStateWritten)
+	{
+		// That delta is gone, so the world file can't be trusted to add up any more. Write all of it next time
+		UWorldStateSubsystem* WorldState = GetGameInstance()->GetSubsystem<UWorldStateSubsystem>();
+		if (WorldState)
+		{
+			WorldState->MarkAllDirty();
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Saved %s in the background: %s, %.2f ms"), *SlotName, bSuccess ? TEXT("ok") : TEXT("failed"), SaveTimeMs);
+
+	OnSaveComplete.Broadcast(bSuccess, SaveTimeMs);
+
+	// Anything that came in while we were writing
+	if (bSavePending)
+	{
+		StartSave();
+	}
+}
+
+FString UPlayerSaveSubsystem::GetSaveDirectory() const
+{
+	// Same place the default save game system puts SaveGameToSlot files, so old saves still get picked up
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames");
+}
+
+FString UPlayerSaveSubsystem::GetSlotPath() const
+{
+	return GetSaveDirectory() / SlotName + TEXT(".sav");
+}
+
+FString UPlayerSaveSubsystem::GetWorldStatePath() const
+{
+	return GetSaveDirectory() / SlotName + TEXT(".world");
+}
+
+float UPlayerSaveSubsystem::GetPlayTimeSeconds() const
+{
+	return LoadedPlayTimeSeconds + (float)(FPlatformTime::Seconds() - PlayTimeStart);
+}
+
+bool UPlayerSaveSubsystem::WriteSaveFile(const FCharacterStats& Stats, float PlayTimeSeconds, int64 Timestamp, bool bCompress, const FString& Path)
+{
+	TArray<uint8> File;
+	if (!FPlayerSaveFormat::Write(Stats, PlayTimeSeconds, Timestamp, bCompress, File))
+	{
+		return false;
+	}
+
+	// Write next to the slot and move it over the top. Until the move the slot file is the old save, untouched
+	// Move deletes the old one and then renames, so if we die in between all that's left is the temp file. See LoadFromDisk
+	const FString TempPath = GetTempPath(Path);
+	if (!FFileHelper::SaveArrayToFile(File, *TempPath))
+	{
+		return false;
+	}
+	return IFileManager::Get().Move(*Path, *TempPath, true, true);
+}
+
+bool UPlayerSaveSubsystem::LoadFromDisk(FCharacterStats& OutStats)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PlayerLoadFromDisk);
+
+	// Don't read a file the worker is still writing, and get anything queued behind it on disk too
+	// Otherwise that write would land after we've loaded and put the older stats back over what we read
+	FlushSaves();
+
+	const FString SlotPath = GetSlotPath();
+	FPlayerSaveHeader Header;
+	if (!ReadSaveFile(SlotPath, OutStats, Header))
+	{
+		// A save that died between Move deleting the slot and renaming the temp file over it. The temp file was finished,
+		// so if its checksum agrees it's the newest save we have. Put it where it should have gone
+		const FString TempPath = GetTempPath(SlotPath);
+		if (IFileManager::Get().FileExists(*SlotPath) || !ReadSaveFile(TempPath, OutStats, Header))
+		{
+			return false;
+		}
+		IFileManager::Get().Move(*SlotPath, *TempPath, true, true);
+	}
+
+	// Carry on counting from wherever that save was up to
+	LoadedPlayTimeSeconds = Header.PlayTimeSeconds;
+	PlayTimeStart = FPlatformTime::Seconds();
+
+	// The world state that goes with it. No file just means nothing had been consumed yet
+	UWorldStateSubsystem* WorldState = GetGameInstance()->GetSubsystem<UWorldStateSubsystem>();
+	if (WorldState)
+	{
+		TArray<uint8> WorldStateFile;
+		if (UWorldStateSubsystem::ReadWorldFile(GetWorldStatePath(), WorldStateFile))
+		{
+			WorldState->LoadFromFile(WorldStateFile);
+		}
+		else
+		{
+			WorldState->Reset();
+		}
+		WorldStateSlotName = SlotName;
+	}
+	return true;
+}
+
+FString UPlayerSaveSubsystem::GetTempPath(const FString& Path)
+{
+	return Path + TEXT(".tmp");
+}
+
+bool UPlayerSaveSubsystem::ReadSaveFile(const FString& Path, FCharacterStats& OutStats, FPlayerSaveHeader& OutHeader)
+{
+	TArray<uint8> File;
+	if (!FFileHelper::LoadFileToArray(File, *Path, FILEREAD_Silent))
+	{
+		return false;
+	}
+	return FPlayerSaveFormat::Read(File, OutStats, OutHeader);
+}
+
+void UPlayerSaveSubsystem::ListSaveSlots(TArray<FPlayerSaveSlotInfo>& OutSlots) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PlayerSaveListSlots);
+
+	OutSlots.Reset();
+
+	const FString Directory = GetSaveDirectory();
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.sav")), true, false);
+
+	// Slots whose only copy is a temp file left by a save that died mid-move, see LoadFromDisk. Rare enough that reading all
+	// of each one to check it's complete doesn't matter, and a half written one isn't listed
+	TArray<FString> TempFiles;
+	IFileManager::Get().FindFiles(TempFiles, *(Directory / TEXT("*.sav.tmp")), true, false);
+	for (const FString& TempFileName : TempFiles)
+	{
+		const FString FileName = FPaths::GetBaseFilename(TempFileName); // Slot.sav
+		if (Files.Contains(FileName)) continue;
+
+		FCharacterStats Stats;
+		FPlayerSaveHeader Header;
+		if (ReadSaveFile(Directory / TempFileName, Stats, Header))
+		{
+			Files.Add(FileName);
+		}
+	}
+
+	for (const FString& FileName : Files)
+	{
+		// A slot we only have the temp file for gets its details read from that
+		FString Path = Directory / FileName;
+		if (!IFileManager::Get().FileExists(*Path))
+		{
+			Path = GetTempPath(Path);
+		}
+
+		FPlayerSaveSlotInfo& Slot = OutSlots.AddDefaulted_GetRef();
+		Slot.SlotName = FPaths::GetBaseFilename(FileName);
+
+		FPlayerSaveHeader Header;
+		const bool bHasHeader = FPlayerSaveFormat::ReadHeader(Path, Header);
+		Slot.Version = bHasHeader ? Header.Version : 0;
+		if (bHasHeader && Header.Version >= 2)
+		{
+			Slot.LevelName = Header.LevelName;
+			Slot.Timestamp = FDateTime(Header.Timestamp);
+			Slot.PlayTimeSeconds = Header.PlayTimeSeconds;
+		}
+		else
+		{
+			// Older files don't have a header worth the name, the file time is the best we can do without loading them
+			Slot.Timestamp = IFileManager::Get().GetTimeStamp(*Path);
+		}
+	}
+
+	OutSlots.Sort([](const FPlayerSaveSlotInfo& A, const FPlayerSaveSlotInfo& B) { return A.Timestamp > B.Timestamp; });
+}
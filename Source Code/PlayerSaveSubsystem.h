@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Async/Future.h"
+#include "FirstSaveGame.h"
+#include "PlayerSaveSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPlayerSaveComplete, bool, bSuccess, float, SaveTimeMs);
+
+/** What a load game menu needs to show for one slot. Comes from the save header only */
+USTRUCT(BlueprintType)
+struct FPlayerSaveSlotInfo
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FString SlotName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FString LevelName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	FDateTime Timestamp;
+
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	float PlayTimeSeconds = 0.f;
+
+	/** Save format version, 0 for files written by SaveGameToSlot. Anything below the current version is migrated when it's loaded */
+	UPROPERTY(BlueprintReadOnly, Category = "SaveGame")
+	int32 Version = 0;
+};
+
+/**
+ * Owns the player's FCharacterStats for the whole session.
+ *
+ * The live copy stays in memory across OpenLevel, so AMain picks its stats back up on a new level without touching the disk.
+ * The disk is only written by an explicit save or an autosave, and that happens off the game thread: the stats are copied
+ * on the game thread, then serialized, compressed and written to a temp file on a worker, which is moved over the slot
+ * file once it's complete. A crash mid-write leaves the old slot file as it was. The move itself deletes the old file before
+ * renaming on some platforms, so a crash right in between leaves only the temp file; loading and listing fall back to it
+ * when the slot file is missing, as long as its checksum says it's complete.
+ * The file layout itself is in FPlayerSaveFormat. Killed/collected/destroyed actors are saved alongside by UWorldStateSubsystem.
+ */
+UCLASS(Config = Game)
+class MYPROJECT_API UPlayerSaveSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPlayerSaveSubsystem();
+
+	// USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Save slot used by SaveGame/LoadGame, same default name UFirstSaveGame had. A load game menu can point this at another slot */
+	UPROPERTY(Config, BlueprintReadWrite, Category = "SaveGame")
+	FString SlotName;
+
+	/** LZ4 the payload. Worth it on handhelds, where the write is slower than the compression */
+	UPROPERTY(Config)
+	bool bCompressSaves;
+
+	/** Write a background save every time the player goes through a level transition */
+	UPROPERTY(Config)
+	bool bAutosaveOnLevelTransition;
+
+	/** Called on the game thread when a background save has finished, with how long the worker took */
+	UPROPERTY(BlueprintAssignable, Category = "SaveGame")
+	FOnPlayerSaveComplete OnSaveComplete;
+
+	/** Replaces the in memory player state. Doesn't touch the disk */
+	void SetPlayerState(const FCharacterStats& Stats);
+
+	/** The in memory player state. The first call of the session falls back to reading the slot, if nothing has been set yet */
+	bool GetPlayerState(FCharacterStats& OutStats);
+
+	FORCEINLINE bool HasPlayerState() const { return bHasPlayerState; }
+
+	/** Sets the in memory state and writes it to the slot in the background. Saves that come in while one is being written are coalesced into one more write of the newest stats */
+	void SaveAsync(const FCharacterStats& Stats);
+
+	/** Reads the slot straight away. Older versions and plain SaveGameToSlot files are migrated as they load */
+	bool LoadFromDisk(FCharacterStats& OutStats);
+
+	FORCEINLINE bool IsSaving() const { return bSaveInFlight; }
+
+	/** Every slot in the save directory, newest first. Only reads the headers, so it stays quick however big the saves get */
+	UFUNCTION(BlueprintCallable, Category = "SaveGame")
+	void ListSaveSlots(TArray<FPlayerSaveSlotInfo>& OutSlots) const;
+
+	/** Play time carried over from the loaded save, plus this session */
+	float GetPlayTimeSeconds() const;
+
+private:
+	/** Kicks off the worker for whatever is in PendingSave */
+	void StartSave();
+
+	/** Back on the game thread once the worker is done */
+	void FinishSave(bool bSuccess, bool bWorldStateWritten, float SaveTimeMs);
+
+	/** Waits for the save being written and writes whatever is queued on this thread, so the slot on disk is the newest save */
+	void FlushSaves();
+
+	/** Gets the world state changes to go with this save from UWorldStateSubsystem. False if there aren't any */
+	bool TakeWorldRecord(TArray<uint8>& OutRecord, bool& bOutFull);
+
+	FString GetSaveDirectory() const;
+	FString GetSlotPath() const;
+	FString GetWorldStatePath() const;
+
+	/** Worker thread half of a save. Plain data in, plain data out */
+	static bool WriteSaveFile(const FCharacterStats& Stats, float PlayTimeSeconds, int64 Timestamp, bool bCompress, const FString& Path);
+
+	/** Where WriteSaveFile writes before moving over Path */
+	static FString GetTempPath(const FString& Path);
+
+	/** Loads and fully checks one save file */
+	static bool ReadSaveFile(const FString& Path, FCharacterStats& OutStats, struct FPlayerSaveHeader& OutHeader);
+
+	FCharacterStats PlayerState;
+	bool bHasPlayerState;
+
+	FCharacterStats PendingSave;
+	bool bSavePending;
+	bool bSaveInFlight;
+
+	TFuture<void> SaveTask;
+
+	/** Slot the world file we're adding deltas to belongs to */
+	FString WorldStateSlotName;
+
+	// Play time from the last loaded save, and when we loaded it
+	float LoadedPlayTimeSeconds;
+	double PlayTimeStart;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PrefetchTriggerComponent.h"
+#include "AssetPrefetchSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Main.h"
+
+UPrefetchTriggerComponent::UPrefetchTriggerComponent()
+{
+	// Only the player sets it off, so only pawns need to be able to overlap it
+	SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+	SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+	SetGenerateOverlapEvents(true);
+	SetSphereRadius(1500.f);
+
+	Priority = 0;
+}
+
+void UPrefetchTriggerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OnComponentBeginOverlap.AddDynamic(this, &UPrefetchTriggerComponent::OnTriggerOverlapBegin);
+}
+
+void UPrefetchTriggerComponent::AddAsset(const FSoftObjectPath& Asset)
+{
+	if (!Asset.IsNull())
+	{
+		RuntimeAssets.AddUnique(Asset);
+	}
+}
+
+void UPrefetchTriggerComponent::OnTriggerOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult)
+{
+	if (Cast<AMain>(OtherActor))
+	{
+		TriggerPrefetch();
+	}
+}
+
+void UPrefetchTriggerComponent::TriggerPrefetch()
+{
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	UAssetPrefetchSubsystem* Prefetcher = GameInstance ? GameInstance->GetSubsystem<UAssetPrefetchSubsystem>() : nullptr;
+	if (Prefetcher == nullptr) return;
+
+	TArray<FSoftObjectPath> Paths = RuntimeAssets;
+	for (const TSoftObjectPtr<UObject>& Asset : Assets)
+	{
+		Paths.AddUnique(Asset.ToSoftObjectPath());
+	}
+
+	// Going back in the sphere again is cheap, anything still loaded just gets marked as recently wanted
+	Prefetcher->Prefetch(Paths, Priority, FSimpleDelegate::CreateUObject(this, &UPrefetchTriggerComponent::OnPrefetched));
+}
+
+void UPrefetchTriggerComponent::OnPrefetched()
+{
+	OnAssetsLoaded.Broadcast();
+}
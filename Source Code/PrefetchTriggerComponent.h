@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SphereComponent.h"
+#include "PrefetchTriggerComponent.generated.h"
+
+/**
+ * A sphere that asks the asset prefetcher for a list of assets when the player walks into it
+ * Designers fill in Assets; the owning actor can add what it knows about at runtime with AddAsset, e.g. a spawn volume's enemy classes
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class MYPROJECT_API UPrefetchTriggerComponent : public USphereComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPrefetchTriggerComponent();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prefetch")
+	TArray<TSoftObjectPtr<UObject>> Assets;
+
+	/** Higher loads first and is evicted last */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prefetch")
+	int32 Priority;
+
+	/** Fires every time a prefetch we started has everything loaded */
+	FSimpleMulticastDelegate OnAssetsLoaded;
+
+	void AddAsset(const FSoftObjectPath& Asset);
+
+	/** Prefetches everything we've got, same as the player walking in */
+	UFUNCTION(BlueprintCallable, Category = "Prefetch")
+	void TriggerPrefetch();
+
+protected:
+	virtual void BeginPlay() override;
+
+	UFUNCTION()
+	void OnTriggerOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult & SweepResult);
+
+private:
+	void OnPrefetched();
+
+	/** Added through AddAsset */
+	TArray<FSoftObjectPath> RuntimeAssets;
+};
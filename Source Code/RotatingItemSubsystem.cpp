@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RotatingItemSubsystem.h"
+#include "MyProject.h"
+#include "Item.h"
+
+DECLARE_CYCLE_STAT(TEXT("Rotating Items"), STAT_RotatingItems, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rotating Items Count"), STAT_RotatingItemsCount, STATGROUP_MyProject);
+
+TStatId URotatingItemSubsystem::GetStatId() const
+{
+	return GET_STATID(STAT_RotatingItems);
+}
+
+void URotatingItemSubsystem::RegisterItem(AItem* Item)
+{
+	if (Item == nullptr || Item->RotatorIndex != INDEX_NONE) return;
+
+	Item->RotatorIndex = Items.Add(Item);
+	Yaws.Add(Item->GetActorRotation().Yaw);
+	Rates.Add(Item->RotationRate);
+}
+
+void URotatingItemSubsystem::UnregisterItem(AItem* Item)
+{
+	if (Item == nullptr || !Items.IsValidIndex(Item->RotatorIndex) || Items[Item->RotatorIndex] != Item) return;
+
+	// Swap the last item into the hole so the arrays stay packed
+	const int32 Index = Item->RotatorIndex;
+	Items.RemoveAtSwap(Index, 1, false);
+	Yaws.RemoveAtSwap(Index, 1, false);
+	Rates.RemoveAtSwap(Index, 1, false);
+	if (Items.IsValidIndex(Index))
+	{
+		Items[Index]->RotatorIndex = Index;
+	}
+
+	Item->RotatorIndex = INDEX_NONE;
+}
+
+void URotatingItemSubsystem::Tick(float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_RotatingItemsCount, Items.Num());
+
+	// Advance every yaw first, it's just a run over two float arrays
+	const int32 Num = Items.Num();
+	for (int32 i = 0; i < Num; i++)
+	{
+		Yaws[i] = FMath::Fmod(Yaws[i] + DeltaTime * Rates[i], 360.f);
+	}
+
+	// Then push them out. Setting the rotation directly and updating the transform skips the sweep and UpdateOverlaps that SetActorRotation does
+	for (int32 i = 0; i < Num; i++)
+	{
+		USceneComponent* Root = Items[i] ? Items[i]->GetRootComponent() : nullptr;
+		if (Root == nullptr) continue;
+
+		FRotator Rotation = Root->GetRelativeRotation();
+		Rotation.Yaw = Yaws[i];
+		Root->SetRelativeRotation_Direct(Rotation);
+		Root->UpdateComponentToWorld(EUpdateTransformFlags::None, ETeleportType::TeleportPhysics);
+	}
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RotatingItemSubsystem.generated.h"
+
+/**
+ * Spins every item with bRotate set, so items themselves don't need to tick
+ * Yaws are kept in a packed array and the new rotations are written straight to each item's root without a sweep or overlap update,
+ * which is fine since spinning in place never changes what a collision sphere overlaps
+ */
+UCLASS()
+class MYPROJECT_API URotatingItemSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Items register themselves when they start rotating and unregister when they stop, go into a pool or leave play
+	void RegisterItem(class AItem* Item);
+	void UnregisterItem(AItem* Item);
+
+	FORCEINLINE int32 GetNumItems() const { return Items.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !IsTemplate() && Items.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+	// Packed arrays, one entry per rotating item. Items keep their index in RotatorIndex
+	UPROPERTY()
+	TArray<AItem*> Items;
+
+	TArray<float> Yaws;
+	TArray<float> Rates;
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpawnTable.h"
+
+bool FSpawnTableAliasSampler::Build(const TArray<float>& Weights)
+{
+	Probability.Reset();
+	Alias.Reset();
+	Columns.Reset();
+
+	// Only things that can actually be picked get a column, so a weight of 0 really is never picked
+	float Total = 0.f;
+	for (int32 i = 0; i < Weights.Num(); i++)
+	{
+		if (Weights[i] > 0.f)
+		{
+			Columns.Add(i);
+			Total += Weights[i];
+		}
+	}
+
+	const int32 Num = Columns.Num();
+	if (Num == 0) return false;
+
+	// Scale everything so the average is 1, then split into the ones under and over that
+	TArray<float> Scaled;
+	Scaled.SetNumUninitialized(Num);
+	TArray<int32> Small;
+	TArray<int32> Large;
+	for (int32 i = 0; i < Num; i++)
+	{
+		Scaled[i] = Weights[Columns[i]] * Num / Total;
+		if (Scaled[i] < 1.f)
+		{
+			Small.Add(i);
+		}
+		else
+		{
+			Large.Add(i);
+		}
+	}
+
+	Probability.SetNumZeroed(Num);
+	Alias.Init(INDEX_NONE, Num);
+
+	// Each small column gets topped up to 1 by borrowing from a large one
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Less = Small.Pop(false);
+		const int32 More = Large.Pop(false);
+
+		Probability[Less] = Scaled[Less];
+		Alias[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.f;
+		if (Scaled[More] < 1.f)
+		{
+			Small.Add(More);
+		}
+		else
+		{
+			Large.Add(More);
+		}
+	}
+
+	// Whatever is left over is (give or take float error) exactly full
+	for (int32 Column : Large)
+	{
+		Probability[Column] = 1.f;
+	}
+	for (int32 Column : Small)
+	{
+		Probability[Column] = 1.f;
+	}
+
+	return true;
+}
+
+int32 FSpawnTableAliasSampler::Sample() const
+{
+	if (Columns.Num() == 0) return INDEX_NONE;
+
+	const int32 Column = FMath::RandRange(0, Columns.Num() - 1);
+	if (FMath::FRand() < Probability[Column] || Alias[Column] == INDEX_NONE)
+	{
+		return Columns[Column];
+	}
+	return Columns[Alias[Column]];
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SpawnTable.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSpawnTableEntry
+{
+	GENERATED_BODY()
+
+	/** Soft so the table doesn't drag every class into memory just by being referenced. The spawn volume loads them for us */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning")
+	TSoftClassPtr<AActor> ActorClass;
+
+	/** How likely this entry is compared to the others. Doesn't need to add up to anything */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning", meta = (ClampMin = "0.0"))
+	float Weight = 1.f;
+
+	/** Most of these a single spawn volume will have alive at once. 0 means no limit */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning", meta = (ClampMin = "0"))
+	int32 MaxAlive = 0;
+};
+
+/**
+ * Walker's alias method. Building is O(n), after that every pick is one random index and one coin flip no matter how many entries there are
+ */
+struct MYPROJECT_API FSpawnTableAliasSampler
+{
+	/** Weights of 0 are never picked. Returns false if nothing can be picked at all */
+	bool Build(const TArray<float>& Weights);
+
+	/** Index into the weights we were built with, or INDEX_NONE if we're empty */
+	int32 Sample() const;
+
+	bool IsEmpty() const { return Columns.Num() == 0; }
+
+private:
+	// One column per pickable entry. Probability is the chance of keeping the column we landed on, otherwise we take its alias
+	TArray<float> Probability;
+	TArray<int32> Alias;
+
+	// Which weight each column stands for
+	TArray<int32> Columns;
+};
+
+/**
+ * A weighted list of things for a spawn volume to spawn
+ */
+UCLASS(BlueprintType)
+class MYPROJECT_API USpawnTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning")
+	TArray<FSpawnTableEntry> Entries;
+};
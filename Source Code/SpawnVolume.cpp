@@ -7,17 +7,53 @@
 #include "Engine/World.h"
 #include "Enemy.h"
 #include "AIController.h"
+#include "EnemyPoolSubsystem.h"
+#include "ItemPoolSubsystem.h"
+#include "Item.h"
+#include "MyProject.h"
+#include "NavigationSystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "AssetPrefetchSubsystem.h"
+#include "PrefetchTriggerComponent.h"
+#include "CombatImpactSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundCue.h"
+#include "Main.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Volume Spawn"), STAT_SpawnVolumeSpawn, STATGROUP_MyProject);
+DECLARE_CYCLE_STAT(TEXT("Spawn Volume Wave Tick"), STAT_SpawnVolumeWaveTick, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawn Volume Wave Steps"), STAT_SpawnVolumeWaveSteps, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawn Volume Wave Actors Finished"), STAT_SpawnVolumeWaveFinished, STATGROUP_MyProject);
+DECLARE_CYCLE_STAT(TEXT("Spawn Volume Build Points"), STAT_SpawnVolumeBuildPoints, STATGROUP_MyProject);
 
 // Sets default values
 ASpawnVolume::ASpawnVolume()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = false;
-	// Should only need to spawn on game beginning, so shouldn't need to tick
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	// We only tick while a wave is being spawned, SpawnWave turns it on and it goes back off once the wave is done
 
 	// Set size of spawning box
 	SpawningBox = CreateDefaultSubobject<UBoxComponent>(TEXT("SpawningBox"));
 
+	PrefetchTrigger = CreateDefaultSubobject<UPrefetchTriggerComponent>(TEXT("PrefetchTrigger"));
+	PrefetchTrigger->SetupAttachment(SpawningBox);
+	PrefetchMargin = 2000.f;
+
+	bUsePooling = false;
+
+	WaveFrameBudgetMs = 2.f;
+
+	SpawnPointSpacing = 150.f;
+	MaxSpawnPoints = 64;
+	SpawnPointHeightOffset = 100.f;
+
+	SpawnTable = nullptr;
+	bSpawnTableLoaded = false;
+	bSpawnSamplerDirty = true;
 
 }
 
@@ -26,12 +62,88 @@ void ASpawnVolume::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if(Actor_1 && Actor_2 && Actor_3 && Actor_4)
+	// Any slots that are filled in, rather than all or nothing
+	for (const TSubclassOf<AActor>& Slot : { Actor_1, Actor_2, Actor_3, Actor_4 })
+	{
+		if (Slot)
+		{
+			SpawnArray.Add(Slot);
+		}
+	}
+
+	// Load the spawn table's classes in the background so the first spawn of each doesn't stall the game thread
+	// We don't hand anything out of the table until they're all in
+	if (SpawnTable)
+	{
+		TArray<FSoftObjectPath> ClassPaths;
+		for (const FSpawnTableEntry& Entry : SpawnTable->Entries)
+		{
+			if (!Entry.ActorClass.IsNull())
+			{
+				ClassPaths.AddUnique(Entry.ActorClass.ToSoftObjectPath());
+			}
+		}
+
+		if (ClassPaths.Num() > 0)
+		{
+			SpawnTableHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ClassPaths, FStreamableDelegate::CreateUObject(this, &ASpawnVolume::OnSpawnTableLoaded));
+		}
+		else
+		{
+			OnSpawnTableLoaded();
+		}
+	}
+	else
+	{
+		bSpawnTableLoaded = true;
+	}
+
+	// Everything we might spawn, so it's loaded and its hit effects are warm by the time the player is close enough to fight
+	for (const TSubclassOf<AActor>& Class : SpawnArray)
+	{
+		PrefetchTrigger->AddAsset(FSoftObjectPath(Class.Get()));
+	}
+	if (SpawnTable)
+	{
+		for (const FSpawnTableEntry& Entry : SpawnTable->Entries)
+		{
+			PrefetchTrigger->AddAsset(Entry.ActorClass.ToSoftObjectPath());
+		}
+	}
+	for (auto& Prewarm : PrewarmCounts)
+	{
+		PrefetchTrigger->AddAsset(FSoftObjectPath(Prewarm.Key.Get()));
+	}
+	PrefetchTrigger->OnAssetsLoaded.AddUObject(this, &ASpawnVolume::WarmEncounter);
+	PrefetchTrigger->SetSphereRadius(SpawningBox->GetScaledBoxExtent().Size() + PrefetchMargin);
+
+	// Baked points are already good to go, otherwise work them out now
+	if (SpawnPoints.Num() == 0)
+	{
+		BuildSpawnPoints();
+	}
+
+	// Pay for constructing our enemies now, while the level is loading, rather than in the middle of a wave
+	UEnemyPoolSubsystem* Pool = GetWorld()->GetSubsystem<UEnemyPoolSubsystem>();
+	if (bUsePooling && Pool)
+	{
+		for (auto& Prewarm : PrewarmCounts)
+		{
+			Pool->Prewarm(Prewarm.Key, Prewarm.Value, GetActorLocation());
+		}
+	}
+
+	// Pooled actors aren't destroyed when they die, they get hidden and go back in the pool, so that's how we hear about those
+	if (SpawnTable)
 	{
-		SpawnArray.Add(Actor_1);
-		SpawnArray.Add(Actor_2);
-		SpawnArray.Add(Actor_3);
-		SpawnArray.Add(Actor_4);
+		if (Pool)
+		{
+			Pool->OnEnemyReleased.AddUObject(this, &ASpawnVolume::OnPooledEnemyReleased);
+		}
+		if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+		{
+			ItemPool->OnItemReleased.AddUObject(this, &ASpawnVolume::OnPooledItemReleased);
+		}
 	}
 	
 }
@@ -41,10 +153,168 @@ void ASpawnVolume::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	SCOPE_CYCLE_COUNTER(STAT_SpawnVolumeWaveTick);
+
+	// Keep stepping through the queue until we run out of work or out of time for this frame
+	// We always do at least one step, otherwise a budget smaller than a single spawn would never finish
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = WaveFrameBudgetMs / 1000.0;
+
+	while (WaveQueue.Num() > 0)
+	{
+		INC_DWORD_STAT(STAT_SpawnVolumeWaveSteps);
+		if (!AdvanceWaveEntry(WaveQueue[0]))
+		{
+			INC_DWORD_STAT(STAT_SpawnVolumeWaveFinished);
+			WaveQueue.RemoveAt(0, 1, false);
+		}
+
+		if (FPlatformTime::Seconds() - StartTime >= BudgetSeconds) break;
+	}
+
+	if (WaveQueue.Num() == 0)
+	{
+		SetActorTickEnabled(false);
+
+		// Copy it out first, so anything bound to the delegate can start another wave straight away
+		TArray<AActor*> Spawned = MoveTemp(WaveSpawned);
+		WaveSpawned.Reset();
+		OnWaveComplete.Broadcast(Spawned);
+	}
+}
+
+void ASpawnVolume::SpawnWave(int32 Count, const TArray<TSubclassOf<AActor>>& ClassMix, float FrameBudgetMs)
+{
+	for (int32 i = 0; i < Count; i++)
+	{
+		// With no class mix, the class is picked when the spawn actually happens so MaxAlive caps see the wave's earlier spawns
+		TSubclassOf<AActor> ToSpawn;
+		if (ClassMix.Num() > 0)
+		{
+			ToSpawn = ClassMix[FMath::RandRange(0, ClassMix.Num() - 1)];
+			if (ToSpawn == nullptr) continue;
+		}
+
+		FSpawnVolumeWaveEntry Entry;
+		Entry.Class = ToSpawn;
+		// Pick the points now so the wave doesn't have to, they're cheap
+		Entry.Location = GetSpawnPoint();
+		WaveQueue.Add(Entry);
+	}
+
+	WaveFrameBudgetMs = FMath::Max(FrameBudgetMs, 0.f);
+
+	// Nothing valid to spawn, tell anyone waiting on us that we're done rather than leaving them hanging
+	if (WaveQueue.Num() == 0)
+	{
+		TArray<AActor*> Spawned = MoveTemp(WaveSpawned);
+		WaveSpawned.Reset();
+		OnWaveComplete.Broadcast(Spawned);
+		return;
+	}
+
+	SetActorTickEnabled(true);
+}
+
+bool ASpawnVolume::AdvanceWaveEntry(FSpawnVolumeWaveEntry& Entry)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return false;
+
+	switch (Entry.Phase)
+	{
+	case EWaveSpawnPhase::Construct:
+	{
+		if (Entry.Class == nullptr)
+		{
+			Entry.Class = GetSpawnActor();
+			if (Entry.Class == nullptr) return false;
+		}
+		NoteClassUsed(Entry.Class);
+
+		// Pooled actors are already built and possessed, so acquiring them is the whole job
+		UEnemyPoolSubsystem* Pool = World->GetSubsystem<UEnemyPoolSubsystem>();
+		if (bUsePooling && Pool && Entry.Class->IsChildOf(AEnemy::StaticClass()))
+		{
+			AEnemy* Enemy = Pool->Acquire(Entry.Class, Entry.Location, FRotator(0.f));
+			if (Enemy)
+			{
+				WaveSpawned.Add(Enemy);
+				NoteSpawned(Enemy);
+			}
+			return false;
+		}
+
+		UItemPoolSubsystem* ItemPool = World->GetSubsystem<UItemPoolSubsystem>();
+		if (ItemPool && Entry.Class->IsChildOf(AItem::StaticClass()) && Entry.Class->GetDefaultObject<AItem>()->bPoolable)
+		{
+			AItem* Item = ItemPool->Acquire(Entry.Class, Entry.Location, FRotator(0.f));
+			if (Item)
+			{
+				WaveSpawned.Add(Item);
+				NoteSpawned(Item);
+			}
+			return false;
+		}
+
+		// Deferred so BeginPlay happens in its own step, it's usually the expensive part
+		Entry.Actor = World->SpawnActorDeferred<AActor>(Entry.Class, FTransform(Entry.Location));
+		if (Entry.Actor == nullptr) return false;
+
+		Entry.Phase = EWaveSpawnPhase::Finish;
+		return true;
+	}
+	case EWaveSpawnPhase::Finish:
+	{
+		if (Entry.Actor == nullptr || Entry.Actor->IsPendingKill()) return false;
+
+		Entry.Actor->FinishSpawning(FTransform(Entry.Location));
+		WaveSpawned.Add(Entry.Actor);
+		NoteSpawned(Entry.Actor);
+
+		// Only enemies need a controller, coins and potions are done here
+		Entry.Phase = Entry.Actor->IsA(AEnemy::StaticClass()) ? EWaveSpawnPhase::Possess : EWaveSpawnPhase::Done;
+		return Entry.Phase != EWaveSpawnPhase::Done;
+	}
+	case EWaveSpawnPhase::Possess:
+	{
+		AEnemy* Enemy = Cast<AEnemy>(Entry.Actor);
+		if (Enemy && !Enemy->IsPendingKill())
+		{
+			SetupEnemyController(Enemy);
+		}
+
+		Entry.Phase = EWaveSpawnPhase::Done;
+		return false;
+	}
+	default:
+		return false;
+	}
+}
+
+void ASpawnVolume::SetupEnemyController(AEnemy* Enemy)
+{
+	Enemy->SpawnDefaultController(); // Will spawn a AI Controller for this and set it for our pawn
+
+	// That takes care of our AI controller, but our Enemy already should have an AI Controller
+	// So what we need to do if we're spawning it here, is to set that variable already
+	// So need to first create a AIController variable
+	AAIController* AICont = Cast<AAIController>(Enemy->GetController()); // Will cast to an AIController
+	if (AICont)
+	{
+		Enemy->AIController = AICont; // Set the AIController on the enemy to our already set AIController
+	}
 }
 
 FVector ASpawnVolume::GetSpawnPoint() // Will pass this FVector into SpawnOurActor in blueprints to give it the Location param
 {
+	// Our cached points are already on the navmesh, so use them when we have them
+	if (SpawnPoints.Num() > 0)
+	{
+		return SpawnPoints[FMath::RandRange(0, SpawnPoints.Num() - 1)];
+	}
+
+	// No navmesh in here (or nothing landed on it), so fall back to any old point in the box
 	// Get a random point in our spawn volume and return that
 	// We can do that by using a function that is available in something called UKismetMathLibrary, which has the function called RandomPointInBoundingBox
 	// That will get a random point in a box
@@ -56,19 +326,165 @@ FVector ASpawnVolume::GetSpawnPoint() // Will pass this FVector into SpawnOurAct
 	return Point;
 }
 
+void ASpawnVolume::BuildSpawnPoints()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnVolumeBuildPoints);
+
+	SpawnPoints.Reset();
+
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSystem = World ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) : nullptr;
+	if (NavSystem == nullptr) return;
+
+	const FVector Extent = SpawningBox->GetScaledBoxExtent();
+	const FVector Origin = SpawningBox->GetComponentLocation();
+	const float Radius = SpawnPointSpacing;
+	const float RadiusSquared = FMath::Square(Radius);
+
+	// Bridson's Poisson-disk sampling over the top of the box
+	// A background grid with cells small enough to hold at most one sample, so checking for neighbours is just a 5x5 look around
+	const float CellSize = Radius / FMath::Sqrt(2.f);
+	const int32 GridWidth = FMath::Max(1, FMath::CeilToInt(Extent.X * 2.f / CellSize));
+	const int32 GridHeight = FMath::Max(1, FMath::CeilToInt(Extent.Y * 2.f / CellSize));
+	TArray<int32> Grid;
+	Grid.Init(INDEX_NONE, GridWidth * GridHeight);
+
+	TArray<FVector2D> Samples;
+	TArray<int32> Active;
+
+	auto CellOf = [&](const FVector2D& Sample)
+	{
+		const int32 X = FMath::Clamp(FMath::FloorToInt(Sample.X / CellSize), 0, GridWidth - 1);
+		const int32 Y = FMath::Clamp(FMath::FloorToInt(Sample.Y / CellSize), 0, GridHeight - 1);
+		return FIntPoint(X, Y);
+	};
+
+	auto IsFarEnough = [&](const FVector2D& Sample)
+	{
+		const FIntPoint Cell = CellOf(Sample);
+		for (int32 Y = FMath::Max(Cell.Y - 2, 0); Y <= FMath::Min(Cell.Y + 2, GridHeight - 1); Y++)
+		{
+			for (int32 X = FMath::Max(Cell.X - 2, 0); X <= FMath::Min(Cell.X + 2, GridWidth - 1); X++)
+			{
+				const int32 Other = Grid[Y * GridWidth + X];
+				if (Other != INDEX_NONE && FVector2D::DistSquared(Samples[Other], Sample) < RadiusSquared) return false;
+			}
+		}
+		return true;
+	};
+
+	auto AddSample = [&](const FVector2D& Sample)
+	{
+		const FIntPoint Cell = CellOf(Sample);
+		Grid[Cell.Y * GridWidth + Cell.X] = Samples.Add(Sample);
+		Active.Add(Samples.Num() - 1);
+	};
+
+	// Samples are kept relative to the corner of the box
+	const FVector2D Size(Extent.X * 2.f, Extent.Y * 2.f);
+	AddSample(FVector2D(FMath::FRandRange(0.f, Size.X), FMath::FRandRange(0.f, Size.Y)));
+
+	const int32 AttemptsPerSample = 30;
+	while (Active.Num() > 0)
+	{
+		const int32 ActiveIndex = FMath::RandRange(0, Active.Num() - 1);
+		const FVector2D Centre = Samples[Active[ActiveIndex]];
+
+		bool bFound = false;
+		for (int32 Attempt = 0; Attempt < AttemptsPerSample; Attempt++)
+		{
+			// Somewhere in the ring between one and two radii out
+			const float Angle = FMath::FRandRange(0.f, 2.f * PI);
+			const float Distance = FMath::FRandRange(Radius, 2.f * Radius);
+			const FVector2D Candidate = Centre + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+
+			if (Candidate.X < 0.f || Candidate.Y < 0.f || Candidate.X >= Size.X || Candidate.Y >= Size.Y) continue;
+			if (!IsFarEnough(Candidate)) continue;
+
+			AddSample(Candidate);
+			bFound = true;
+			break;
+		}
+
+		// Nothing fits around this one anymore
+		if (!bFound)
+		{
+			Active.RemoveAtSwap(ActiveIndex);
+		}
+	}
+
+	// Shuffle so that if MaxSpawnPoints cuts us off early, what's left is still spread across the whole box
+	for (int32 i = Samples.Num() - 1; i > 0; i--)
+	{
+		Samples.Swap(i, FMath::RandRange(0, i));
+	}
+
+	// Drop every sample onto the navmesh. Anything that doesn't land (walls, holes, rocks) gets thrown out
+	const FVector QueryExtent(Radius * 0.5f, Radius * 0.5f, Extent.Z * 2.f);
+	const FVector Corner = Origin - FVector(Extent.X, Extent.Y, 0.f);
+	for (const FVector2D& Sample : Samples)
+	{
+		if (SpawnPoints.Num() >= MaxSpawnPoints) break;
+
+		FNavLocation NavLocation;
+		const FVector Point = Corner + FVector(Sample.X, Sample.Y, 0.f);
+		if (!NavSystem->ProjectPointToNavigation(Point, NavLocation, QueryExtent)) continue;
+
+		// Projection can pull a point outside of the box, or onto a point we already have
+		const FVector Local = NavLocation.Location - Origin;
+		if (FMath::Abs(Local.X) > Extent.X || FMath::Abs(Local.Y) > Extent.Y) continue;
+
+		bool bTooClose = false;
+		for (const FVector& Existing : SpawnPoints)
+		{
+			if (FVector::DistSquared2D(Existing, NavLocation.Location) < RadiusSquared * 0.25f)
+			{
+				bTooClose = true;
+				break;
+			}
+		}
+		if (bTooClose) continue;
+
+		SpawnPoints.Add(NavLocation.Location + FVector(0.f, 0.f, SpawnPointHeightOffset));
+	}
+
+	SpawnPoints.Shrink();
+}
+
 void ASpawnVolume::SpawnOurActor_Implementation(UClass* ToSpawn, const FVector& Location)
 {
 	// When we make a BlueprintNative event, our C++ implementation has to be called the above, our function name with _Implementation
 	// This way UE knows this is the implementation we scripted out in C++ so that part of it will also be carried out in blueprints
+	SCOPE_CYCLE_COUNTER(STAT_SpawnVolumeSpawn);
+
 	if (ToSpawn)
 	{
 		UWorld* World = GetWorld();
 		FActorSpawnParameters SpawnParams;
 
+		NoteClassUsed(ToSpawn);
+
+		// Pooled enemies already have their AIController, so there's nothing else to set up
+		UEnemyPoolSubsystem* Pool = World ? World->GetSubsystem<UEnemyPoolSubsystem>() : nullptr;
+		if (bUsePooling && Pool && ToSpawn->IsChildOf(AEnemy::StaticClass()))
+		{
+			NoteSpawned(Pool->Acquire(ToSpawn, Location, FRotator(0.f)));
+			return;
+		}
+
+		// Same for coins, potions and anything else that's opted in to the item pool
+		UItemPoolSubsystem* ItemPool = World ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr;
+		if (ItemPool && ToSpawn->IsChildOf(AItem::StaticClass()) && ToSpawn->GetDefaultObject<AItem>()->bPoolable)
+		{
+			NoteSpawned(ItemPool->Acquire(ToSpawn, Location, FRotator(0.f)));
+			return;
+		}
+
 		if (World)
 		{
 			AActor* Actor = World->SpawnActor<AActor>(ToSpawn, Location, FRotator(0.f), SpawnParams); 
 			// This constructs and spawns an actor that we set, and then returns that actor (set the actor to spawn in blueprints on the GetSpawnActor Array)
+			NoteSpawned(Actor);
 
 			// Check to see if we're spawning enemies and not just actors
 			// Our spawn volume can be used to spawn potions, coins, pretty much anything
@@ -76,16 +492,7 @@ void ASpawnVolume::SpawnOurActor_Implementation(UClass* ToSpawn, const FVector&
 			AEnemy* Enemy = Cast<AEnemy>(Actor);
 			if (Enemy)
 			{
-				Enemy->SpawnDefaultController(); // Will spawn a AI Controller for this and set it for our pawn
-
-				// That takes care of our AI controller, but our Enemy already should have an AI Controller
-				// So what we need to do if we're spawning it here, is to set that variable already
-				// So need to first create a AIController variable
-				AAIController* AICont = Cast<AAIController>(Enemy->GetController()); // Will cast to an AIController
-				if (AICont)
-				{
-					Enemy->AIController = AICont; // Set the AIController on the enemy to our already set AIController
-				}
+				SetupEnemyController(Enemy);
 			}
 		}
 	}
@@ -93,6 +500,21 @@ void ASpawnVolume::SpawnOurActor_Implementation(UClass* ToSpawn, const FVector&
 
 TSubclassOf<AActor> ASpawnVolume::GetSpawnActor()
 {
+	if (SpawnTable)
+	{
+		// Still loading, nothing to hand out yet
+		if (!bSpawnTableLoaded) return nullptr;
+
+		// Only rebuilt when an entry hits its cap or comes off it, see NoteSpawned and NoteGone
+		if (bSpawnSamplerDirty)
+		{
+			RebuildSpawnSampler();
+		}
+
+		const int32 Index = SpawnSampler.Sample();
+		return Index != INDEX_NONE ? SpawnTableClasses[Index] : nullptr;
+	}
+
 	if (SpawnArray.Num() > 0)
 	{
 		int32 Selection = FMath::RandRange(0, SpawnArray.Num() - 1); // Element numbers will be 4, but we can't index the 4th number so we have to start at 0 instead of 1
@@ -105,4 +527,167 @@ TSubclassOf<AActor> ASpawnVolume::GetSpawnActor()
 		// If spawn array is empty, return null
 		return nullptr;
 	}
-}
\ No newline at end of file
+}
+
+void ASpawnVolume::OnSpawnTableLoaded()
+{
+	if (SpawnTable == nullptr) return;
+
+	const int32 NumEntries = SpawnTable->Entries.Num();
+	SpawnTableClasses.SetNum(NumEntries);
+	SpawnTableAlive.SetNum(NumEntries);
+	SpawnTableCapped.Init(false, NumEntries);
+	SpawnTableIndexByClass.Reset();
+
+	for (int32 i = 0; i < NumEntries; i++)
+	{
+		// Anything that failed to load just stays null and gets a weight of 0
+		SpawnTableClasses[i] = SpawnTable->Entries[i].ActorClass.Get();
+		if (SpawnTableClasses[i])
+		{
+			SpawnTableIndexByClass.Add(SpawnTableClasses[i], i);
+		}
+	}
+
+	bSpawnSamplerDirty = true;
+	bSpawnTableLoaded = true;
+
+	OnSpawnVolumeReady.Broadcast();
+}
+
+void ASpawnVolume::RebuildSpawnSampler()
+{
+	TArray<float> Weights;
+	Weights.SetNumZeroed(SpawnTableClasses.Num());
+	for (int32 i = 0; i < Weights.Num(); i++)
+	{
+		if (SpawnTableClasses[i] && !SpawnTableCapped[i])
+		{
+			Weights[i] = SpawnTable->Entries[i].Weight;
+		}
+	}
+
+	SpawnSampler.Build(Weights);
+	bSpawnSamplerDirty = false;
+}
+
+void ASpawnVolume::NoteSpawned(AActor* Actor)
+{
+	if (Actor == nullptr || !bSpawnTableLoaded || SpawnTable == nullptr) return;
+
+	const int32* Index = SpawnTableIndexByClass.Find(Actor->GetClass());
+	if (Index == nullptr) return;
+
+	const int32 MaxAlive = SpawnTable->Entries[*Index].MaxAlive;
+	if (MaxAlive <= 0) return;
+
+	Actor->OnDestroyed.AddUniqueDynamic(this, &ASpawnVolume::OnSpawnedActorDestroyed);
+
+	SpawnTableAlive[*Index].Add(Actor);
+	if (!SpawnTableCapped[*Index] && SpawnTableAlive[*Index].Num() >= MaxAlive)
+	{
+		SpawnTableCapped[*Index] = true;
+		bSpawnSamplerDirty = true;
+	}
+}
+
+void ASpawnVolume::NoteGone(AActor* Actor)
+{
+	if (Actor == nullptr || !bSpawnTableLoaded || SpawnTable == nullptr) return;
+
+	const int32* Index = SpawnTableIndexByClass.Find(Actor->GetClass());
+	if (Index == nullptr) return;
+
+	// Pools are shared by every volume, so plenty of what comes through here was never ours
+	if (SpawnTableAlive[*Index].RemoveSwap(Actor) == 0) return;
+
+	if (SpawnTableCapped[*Index] && SpawnTableAlive[*Index].Num() < SpawnTable->Entries[*Index].MaxAlive)
+	{
+		SpawnTableCapped[*Index] = false;
+		bSpawnSamplerDirty = true;
+	}
+}
+
+void ASpawnVolume::OnSpawnedActorDestroyed(AActor* DestroyedActor)
+{
+	NoteGone(DestroyedActor);
+}
+
+void ASpawnVolume::OnPooledEnemyReleased(AEnemy* Enemy)
+{
+	NoteGone(Enemy);
+}
+
+void ASpawnVolume::OnPooledItemReleased(AItem* Item)
+{
+	NoteGone(Item);
+}
+
+void ASpawnVolume::PrefetchEncounter()
+{
+	PrefetchTrigger->TriggerPrefetch();
+}
+
+void ASpawnVolume::NoteClassUsed(UClass* Class)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	UAssetPrefetchSubsystem* Prefetcher = GameInstance ? GameInstance->GetSubsystem<UAssetPrefetchSubsystem>() : nullptr;
+	if (Prefetcher)
+	{
+		Prefetcher->NoteUse(Class);
+	}
+}
+
+void ASpawnVolume::WarmEncounter()
+{
+	UWorld* World = GetWorld();
+	UCombatImpactSubsystem* Impacts = World ? World->GetSubsystem<UCombatImpactSubsystem>() : nullptr;
+	if (Impacts == nullptr) return;
+
+	// The table's own load may not have finished yet, but the prefetch that got us here has, so go straight to the soft pointers
+	TArray<UClass*> Classes;
+	if (SpawnTable)
+	{
+		for (const FSpawnTableEntry& Entry : SpawnTable->Entries)
+		{
+			Classes.Add(Entry.ActorClass.Get());
+		}
+	}
+	for (const TSubclassOf<AActor>& Class : SpawnArray)
+	{
+		Classes.Add(Class);
+	}
+	for (auto& Prewarm : PrewarmCounts)
+	{
+		Classes.Add(Prewarm.Key.Get());
+	}
+
+	// Enemies get hit by the player and the player gets hit by enemies, so both sides' effects are about to be needed
+	TArray<FSoftObjectPath> ImpactAssets;
+	for (UClass* Class : Classes)
+	{
+		const AEnemy* Enemy = (Class && Class->IsChildOf(AEnemy::StaticClass())) ? Class->GetDefaultObject<AEnemy>() : nullptr;
+		if (Enemy)
+		{
+			Impacts->WarmImpact(Enemy->HitParticles, Enemy->HitSound);
+			ImpactAssets.Add(FSoftObjectPath(Enemy->HitParticles));
+			ImpactAssets.Add(FSoftObjectPath(Enemy->HitSound));
+		}
+	}
+
+	AMain* Main = Cast<AMain>(UGameplayStatics::GetPlayerCharacter(this, 0));
+	if (Main)
+	{
+		Impacts->WarmImpact(Main->HitParticles, Main->HitSound);
+		ImpactAssets.Add(FSoftObjectPath(Main->HitParticles));
+		ImpactAssets.Add(FSoftObjectPath(Main->HitSound));
+	}
+
+	// They're in memory already, this is so the prefetcher holds on to them and counts their first hit
+	UGameInstance* GameInstance = GetGameInstance();
+	UAssetPrefetchSubsystem* Prefetcher = GameInstance ? GameInstance->GetSubsystem<UAssetPrefetchSubsystem>() : nullptr;
+	if (Prefetcher)
+	{
+		Prefetcher->Prefetch(ImpactAssets, PrefetchTrigger->Priority);
+	}
+}
@@ -4,8 +4,38 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
+#include "SpawnTable.h"
 #include "SpawnVolume.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSpawnWaveComplete, const TArray<AActor*>&, SpawnedActors);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSpawnVolumeReady);
+
+// Where each actor in a wave is up to. Each step is done on its own, so one spawn can be spread over a few frames
+enum class EWaveSpawnPhase : uint8
+{
+	Construct,	// SpawnActorDeferred, constructor and components
+	Finish,		// FinishSpawning, which runs BeginPlay
+	Possess,	// Give enemies their AIController
+	Done
+};
+
+USTRUCT()
+struct FSpawnVolumeWaveEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UClass* Class = nullptr;
+
+	UPROPERTY()
+	AActor* Actor = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+
+	EWaveSpawnPhase Phase = EWaveSpawnPhase::Construct;
+};
+
 UCLASS()
 class MYPROJECT_API ASpawnVolume : public AActor
 {
@@ -34,6 +64,60 @@ public:
 
 	TArray<TSubclassOf<AActor>> SpawnArray; // An array we'll use to store the 4 actors we're going to choose from to possibly spawn
 
+	/** Weighted list of what to spawn. When set, this is used instead of Actor_1 to Actor_4 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning")
+	class USpawnTable* SpawnTable;
+
+	/** Fires once every class in SpawnTable has finished loading and GetSpawnActor can start handing them out */
+	UPROPERTY(BlueprintAssignable, Category = "Spawning")
+	FOnSpawnVolumeReady OnSpawnVolumeReady;
+
+	UFUNCTION(BlueprintPure, Category = "Spawning")
+	bool IsSpawnVolumeReady() const { return bSpawnTableLoaded; }
+
+	/** When true, enemies we spawn come out of (and go back into) the world's enemy pool instead of being spawned and destroyed every time */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning | Pooling")
+	bool bUsePooling;
+
+	/** How many of each enemy class to have waiting in the pool before the first wave, so the first spawns don't hitch either */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning | Pooling", meta = (EditCondition = "bUsePooling"))
+	TMap<TSubclassOf<class AEnemy>, int32> PrewarmCounts;
+
+	/** Closest any two cached spawn points are allowed to be */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning | Points", meta = (ClampMin = "10.0"))
+	float SpawnPointSpacing;
+
+	/** Most spawn points we'll keep. Sampling stops once we have this many */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning | Points", meta = (ClampMin = "1"))
+	int32 MaxSpawnPoints;
+
+	/** How high above the navmesh to spawn, so capsules don't start out stuck in the floor */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning | Points")
+	float SpawnPointHeightOffset;
+
+	/**
+	 * Points inside SpawningBox that are spread out and sit on the navmesh. GetSpawnPoint picks from these
+	 * Built in BeginPlay if empty, or baked into the level with BuildSpawnPoints so BeginPlay doesn't have to
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Spawning | Points")
+	TArray<FVector> SpawnPoints;
+
+	/** Poisson-disk samples the box, projects them onto the navmesh and keeps the ones that land */
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Spawning | Points")
+	void BuildSpawnPoints();
+
+	/** Starts loading our enemies and warming their hit effects when the player gets this close to the box */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Spawning | Prefetch")
+	class UPrefetchTriggerComponent* PrefetchTrigger;
+
+	/** How far past the corners of the box the prefetch trigger reaches */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Spawning | Prefetch", meta = (ClampMin = "0.0"))
+	float PrefetchMargin;
+
+	/** Prefetches everything we can spawn, as if the player had walked up. Floor switches call this for the volumes behind their doors */
+	UFUNCTION(BlueprintCallable, Category = "Spawning | Prefetch")
+	void PrefetchEncounter();
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -52,4 +136,76 @@ public:
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Spawning")
 	void SpawnOurActor(UClass* ToSpawn, const FVector& Location);
 
+	/**
+	 * Spawns Count actors at random spawn points, picking classes at random from ClassMix (or from Actor_1-4 if it's empty)
+	 * Work is spread over as many frames as it takes to stay inside FrameBudgetMs each frame. OnWaveComplete fires once everything is spawned
+	 * Calling this while a wave is still going adds to that wave
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void SpawnWave(int32 Count, const TArray<TSubclassOf<AActor>>& ClassMix, float FrameBudgetMs = 2.f);
+
+	UFUNCTION(BlueprintPure, Category = "Spawning")
+	bool IsSpawningWave() const { return WaveQueue.Num() > 0; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Spawning")
+	FOnSpawnWaveComplete OnWaveComplete;
+
+protected:
+	/** Spawns still to do for the current wave, oldest first */
+	UPROPERTY(Transient)
+	TArray<FSpawnVolumeWaveEntry> WaveQueue;
+
+	/** Everything the current wave has spawned so far, handed to OnWaveComplete */
+	UPROPERTY(Transient)
+	TArray<AActor*> WaveSpawned;
+
+	float WaveFrameBudgetMs;
+
+	/** Does the next bit of work on a wave entry. Returns false once the entry is finished */
+	bool AdvanceWaveEntry(FSpawnVolumeWaveEntry& Entry);
+
+	/** Spawns and hooks up the AIController for an enemy we spawned ourselves */
+	void SetupEnemyController(class AEnemy* Enemy);
+
+	// Spawn table state. Everything here is indexed the same as SpawnTable->Entries
+	bool bSpawnTableLoaded;
+
+	/** Keeps the table's classes loaded for as long as we're around */
+	TSharedPtr<FStreamableHandle> SpawnTableHandle;
+
+	UPROPERTY(Transient)
+	TArray<UClass*> SpawnTableClasses;
+
+	TMap<UClass*, int32> SpawnTableIndexByClass;
+
+	/** What we've spawned from each entry that's still alive, for MaxAlive. Kept up to date by NoteSpawned and NoteGone */
+	TArray<TArray<TWeakObjectPtr<AActor>>> SpawnTableAlive;
+
+	/** Entries that hit MaxAlive and are left out of the sampler until something of theirs dies */
+	TArray<bool> SpawnTableCapped;
+
+	FSpawnTableAliasSampler SpawnSampler;
+	bool bSpawnSamplerDirty;
+
+	void OnSpawnTableLoaded();
+	void RebuildSpawnSampler();
+
+	/** Counts a freshly spawned actor against its entry's MaxAlive */
+	void NoteSpawned(AActor* Actor);
+
+	/** Takes something we spawned off its entry's count once it's destroyed or goes back in a pool, and uncaps the entry if that frees a slot */
+	void NoteGone(AActor* Actor);
+
+	UFUNCTION()
+	void OnSpawnedActorDestroyed(AActor* DestroyedActor);
+
+	void OnPooledEnemyReleased(class AEnemy* Enemy);
+	void OnPooledItemReleased(class AItem* Item);
+
+	/** Tells the prefetcher a class is being spawned, for its hit and miss counts */
+	void NoteClassUsed(UClass* Class);
+
+	/** Once our classes are in, gets the hit effects of everything that'll be fighting here ready */
+	void WarmEncounter();
+
 };
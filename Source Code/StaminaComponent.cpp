@@ -0,0 +1,221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StaminaComponent.h"
+#include "GameplayTimerSubsystem.h"
+
+void FStaminaModel::Reset(float Stamina, EStaminaStatus InStatus, float Time)
+{
+	Status = InStatus;
+	if (Status == EStaminaStatus::ESS_Exhausted && !bSprintHeld)
+	{
+		Status = EStaminaStatus::ESS_ExhaustedRecovering;
+	}
+	AnchorStamina = FMath::Clamp(Stamina, 0.f, MaxStamina);
+	AnchorTime = Time;
+}
+
+float FStaminaModel::GetRate() const
+{
+	switch (Status)
+	{
+	case EStaminaStatus::ESS_Normal:
+		if (bSprintHeld) return -Rate;
+		return AnchorStamina >= MaxStamina ? 0.f : Rate; // Full up, nothing to recover
+
+	case EStaminaStatus::ESS_BelowMinimum:
+		return bSprintHeld ? -Rate : Rate;
+
+	case EStaminaStatus::ESS_Exhausted:
+		return bSprintHeld ? 0.f : Rate; // Stuck at 0 until the key is let go
+
+	case EStaminaStatus::ESS_ExhaustedRecovering:
+		return Rate; // Holding sprint doesn't do anything until we're back to MinSprintStamina
+
+	default:
+		return 0.f;
+	}
+}
+
+bool FStaminaModel::GetNextThreshold(float& OutStamina, EStaminaStatus& OutStatus) const
+{
+	const float CurrentRate = GetRate();
+	if (CurrentRate == 0.f) return false;
+
+	switch (Status)
+	{
+	case EStaminaStatus::ESS_Normal:
+		if (CurrentRate < 0.f)
+		{
+			OutStamina = MinSprintStamina;
+			OutStatus = EStaminaStatus::ESS_BelowMinimum;
+		}
+		else
+		{
+			// Filling up to the max doesn't change the status, it just stops the recovery
+			OutStamina = MaxStamina;
+			OutStatus = EStaminaStatus::ESS_Normal;
+		}
+		return true;
+
+	case EStaminaStatus::ESS_BelowMinimum:
+		if (CurrentRate < 0.f)
+		{
+			OutStamina = 0.f;
+			OutStatus = EStaminaStatus::ESS_Exhausted;
+		}
+		else
+		{
+			OutStamina = MinSprintStamina;
+			OutStatus = EStaminaStatus::ESS_Normal;
+		}
+		return true;
+
+	case EStaminaStatus::ESS_Exhausted:
+	case EStaminaStatus::ESS_ExhaustedRecovering:
+		OutStamina = MinSprintStamina;
+		OutStatus = EStaminaStatus::ESS_Normal;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+float FStaminaModel::GetNextTransitionTime() const
+{
+	float Threshold;
+	EStaminaStatus NextStatus;
+	if (!GetNextThreshold(Threshold, NextStatus)) return -1.f;
+
+	// Already past it (stamina set outright below a threshold) means right away
+	return FMath::Max(AnchorTime + (Threshold - AnchorStamina) / GetRate(), AnchorTime);
+}
+
+void FStaminaModel::AdvanceTo(float Time)
+{
+	// Each status has at most one way out in the direction we're heading, so this only goes around a couple of times
+	for (int32 Step = 0; Step < static_cast<int32>(EStaminaStatus::ESS_MAX); Step++)
+	{
+		float Threshold;
+		EStaminaStatus NextStatus;
+		if (!GetNextThreshold(Threshold, NextStatus)) break;
+
+		const float TransitionTime = FMath::Max(AnchorTime + (Threshold - AnchorStamina) / GetRate(), AnchorTime);
+		if (TransitionTime > Time) break;
+
+		AnchorStamina = Threshold;
+		AnchorTime = TransitionTime;
+		Status = NextStatus;
+	}
+
+	AnchorStamina = GetStamina(Time);
+	AnchorTime = FMath::Max(Time, AnchorTime);
+}
+
+void FStaminaModel::SetSprintHeld(bool bHeld, float Time)
+{
+	AdvanceTo(Time);
+	bSprintHeld = bHeld;
+
+	// Letting go while exhausted is what starts the recovery
+	if (!bSprintHeld && Status == EStaminaStatus::ESS_Exhausted)
+	{
+		Status = EStaminaStatus::ESS_ExhaustedRecovering;
+	}
+}
+
+float FStaminaModel::GetStamina(float Time) const
+{
+	// Every threshold keeps going the same direction at the same rate (or stops at 0/max), so clamping the line is all we need
+	return FMath::Clamp(AnchorStamina + GetRate() * FMath::Max(Time - AnchorTime, 0.f), 0.f, MaxStamina);
+}
+
+UStaminaComponent::UStaminaComponent()
+{
+	// The whole point is to not do this every frame
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+float UStaminaComponent::GetTime() const
+{
+	UWorld* World = GetWorld();
+	return World ? World->GetTimeSeconds() : 0.f;
+}
+
+void UStaminaComponent::Configure(float MaxStamina, float MinSprintStamina, float Rate, float Stamina, EStaminaStatus Status)
+{
+	Model.MaxStamina = MaxStamina;
+	Model.MinSprintStamina = MinSprintStamina;
+	Model.Rate = Rate;
+
+	const EStaminaStatus OldStatus = Model.Status;
+	Model.Reset(Stamina, Status, GetTime());
+	BroadcastIfChanged(OldStatus);
+	ScheduleTransition();
+}
+
+void UStaminaComponent::SetSprintHeld(bool bHeld)
+{
+	if (Model.bSprintHeld == bHeld) return;
+
+	const EStaminaStatus OldStatus = Model.Status;
+	Model.SetSprintHeld(bHeld, GetTime());
+	BroadcastIfChanged(OldStatus);
+	ScheduleTransition();
+}
+
+void UStaminaComponent::SetStamina(float Stamina)
+{
+	Model.Reset(Stamina, Model.Status, GetTime());
+	ScheduleTransition();
+}
+
+float UStaminaComponent::GetStamina() const
+{
+	return Model.GetStamina(GetTime());
+}
+
+void UStaminaComponent::ScheduleTransition()
+{
+	UWorld* World = GetWorld();
+	UGameplayTimerSubsystem* Timers = World ? World->GetSubsystem<UGameplayTimerSubsystem>() : nullptr;
+	if (Timers == nullptr) return;
+
+	const float NextTime = Model.GetNextTransitionTime();
+	if (NextTime < 0.f)
+	{
+		Timers->ClearTimer(TransitionTimer);
+		return;
+	}
+
+	Timers->SetTimer(TransitionTimer, this, &UStaminaComponent::OnTransition, FMath::Max(NextTime - GetTime(), 0.f));
+}
+
+void UStaminaComponent::OnTransition()
+{
+	const EStaminaStatus OldStatus = Model.Status;
+	Model.AdvanceTo(GetTime());
+	BroadcastIfChanged(OldStatus);
+	ScheduleTransition();
+}
+
+void UStaminaComponent::BroadcastIfChanged(EStaminaStatus OldStatus)
+{
+	if (Model.Status != OldStatus)
+	{
+		OnStaminaStatusChanged.Broadcast(Model.Status);
+	}
+}
+
+void UStaminaComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UWorld* World = GetWorld();
+	UGameplayTimerSubsystem* Timers = World ? World->GetSubsystem<UGameplayTimerSubsystem>() : nullptr;
+	if (Timers)
+	{
+		Timers->ClearTimer(TransitionTimer);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameplayTimingWheel.h"
+#include "StaminaComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EStaminaStatus : uint8
+{
+	ESS_Normal UMETA(DisplayName = "Normal"),
+	ESS_BelowMinimum UMETA(DisplayName = "BelowMinimum"),
+	ESS_Exhausted UMETA(DisplayName = "Exhausted"),
+	ESS_ExhaustedRecovering UMETA(DisplayName = "ExhaustedRecovering"),
+
+	ESS_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/**
+ * The stamina state machine AMain used to step every frame, worked out analytically instead
+ * Between thresholds stamina is a straight line, so all we keep is where it was at AnchorTime and which way it's heading
+ * Times are passed in rather than read from a world, so this can be driven (and tested) on its own
+ */
+struct MYPROJECT_API FStaminaModel
+{
+	float MaxStamina = 150.f;
+	float MinSprintStamina = 50.f;
+	float Rate = 25.f; // Drain and recovery both happen at this rate
+
+	EStaminaStatus Status = EStaminaStatus::ESS_Normal;
+	bool bSprintHeld = false;
+
+	float AnchorStamina = 0.f;
+	float AnchorTime = 0.f;
+
+	/** Starts over from Stamina at Time */
+	void Reset(float Stamina, EStaminaStatus InStatus, float Time);
+
+	/** Moves the anchor up to Time, going through every threshold crossed on the way */
+	void AdvanceTo(float Time);
+
+	/** Sprint key pressed or released at Time */
+	void SetSprintHeld(bool bHeld, float Time);
+
+	/** How much stamina we have at Time. Exact even if transitions between now and then haven't been applied yet */
+	float GetStamina(float Time) const;
+
+	/** Stamina per second right now, negative while draining */
+	float GetRate() const;
+
+	/** When the next threshold (MinSprintStamina, 0 or MaxStamina) gets crossed, or a negative number if stamina isn't changing */
+	float GetNextTransitionTime() const;
+
+	/** Only Normal and BelowMinimum let you sprint */
+	bool CanSprint() const { return Status == EStaminaStatus::ESS_Normal || Status == EStaminaStatus::ESS_BelowMinimum; }
+
+private:
+	bool GetNextThreshold(float& OutStamina, EStaminaStatus& OutStatus) const;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnStaminaStatusChanged, EStaminaStatus);
+
+/**
+ * Runs an FStaminaModel off the gameplay timer subsystem. Doesn't tick, there's one timer set for the next threshold and stamina
+ * is worked out when somebody asks for it
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class MYPROJECT_API UStaminaComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UStaminaComponent();
+
+	/** Sets up the model and starts it from Stamina */
+	void Configure(float MaxStamina, float MinSprintStamina, float Rate, float Stamina, EStaminaStatus Status = EStaminaStatus::ESS_Normal);
+
+	void SetSprintHeld(bool bHeld);
+
+	/** For loading, potions and anything else that sets stamina outright. Keeps the current status */
+	void SetStamina(float Stamina);
+
+	UFUNCTION(BlueprintPure, Category = "Stamina")
+	float GetStamina() const;
+
+	UFUNCTION(BlueprintPure, Category = "Stamina")
+	EStaminaStatus GetStaminaStatus() const { return Model.Status; }
+
+	UFUNCTION(BlueprintPure, Category = "Stamina")
+	bool CanSprint() const { return Model.CanSprint(); }
+
+	FORCEINLINE const FStaminaModel& GetModel() const { return Model; }
+
+	/** Fires whenever the status changes, either from a threshold or the sprint key */
+	FOnStaminaStatusChanged OnStaminaStatusChanged;
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	FStaminaModel Model;
+
+	FGameplayTimerHandle TransitionTimer;
+
+	float GetTime() const;
+
+	/** Sets the timer for the next threshold, or clears it if stamina has stopped moving */
+	void ScheduleTransition();
+
+	/** Timer callback, applies whatever transitions are due */
+	void OnTransition();
+
+	void BroadcastIfChanged(EStaminaStatus OldStatus);
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "StaminaComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// All of these use the same numbers as AMain's defaults: 150 max, 50 to sprint, 25 a second both ways
+// So from full, sprinting hits the minimum after 4 seconds and runs out after 6, and recovering from 0 gets back to the minimum after 2
+static FStaminaModel MakeDefaultStaminaModel(float Stamina)
+{
+	FStaminaModel Model;
+	Model.MaxStamina = 150.f;
+	Model.MinSprintStamina = 50.f;
+	Model.Rate = 25.f;
+	Model.Reset(Stamina, EStaminaStatus::ESS_Normal, 0.f);
+	return Model;
+}
+
+// Sprint from full until exhausted, hold the key a while at 0, then let go and recover all the way back up
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStaminaModelDrainAndRecoveryTest, "MyProject.Stamina.DrainAndRecovery",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FStaminaModelDrainAndRecoveryTest::RunTest(const FString& Parameters)
+{
+	FStaminaModel Model = MakeDefaultStaminaModel(150.f);
+	TestEqual(TEXT("Full and not sprinting doesn't change"), Model.GetNextTransitionTime(), -1.f);
+
+	Model.SetSprintHeld(true, 0.f);
+	TestEqual(TEXT("Draining"), Model.GetRate(), -25.f);
+	TestEqual(TEXT("Reaches the minimum at 4s"), Model.GetNextTransitionTime(), 4.f);
+	TestEqual(TEXT("Stamina partway down"), Model.GetStamina(2.f), 100.f);
+
+	Model.AdvanceTo(4.f);
+	TestTrue(TEXT("Below minimum at 4s"), Model.Status == EStaminaStatus::ESS_BelowMinimum);
+	TestTrue(TEXT("Can still sprint below the minimum"), Model.CanSprint());
+	TestEqual(TEXT("Runs out at 6s"), Model.GetNextTransitionTime(), 6.f);
+
+	Model.AdvanceTo(6.f);
+	TestTrue(TEXT("Exhausted at 6s"), Model.Status == EStaminaStatus::ESS_Exhausted);
+	TestFalse(TEXT("Can't sprint exhausted"), Model.CanSprint());
+	TestEqual(TEXT("Stays at 0 while the key is held"), Model.GetRate(), 0.f);
+	TestEqual(TEXT("Nothing scheduled while the key is held"), Model.GetNextTransitionTime(), -1.f);
+	TestEqual(TEXT("Still empty later"), Model.GetStamina(8.f), 0.f);
+
+	// Letting go is what starts the recovery, not running out
+	Model.SetSprintHeld(false, 8.f);
+	TestTrue(TEXT("Recovering once the key is let go"), Model.Status == EStaminaStatus::ESS_ExhaustedRecovering);
+	TestEqual(TEXT("Recovers at the same rate"), Model.GetRate(), 25.f);
+	TestEqual(TEXT("Back to the minimum 2s after letting go"), Model.GetNextTransitionTime(), 10.f);
+
+	// Pressing sprint again before then doesn't help
+	Model.SetSprintHeld(true, 9.f);
+	TestTrue(TEXT("Still recovering with the key held"), Model.Status == EStaminaStatus::ESS_ExhaustedRecovering);
+	TestFalse(TEXT("Can't sprint while recovering"), Model.CanSprint());
+	TestEqual(TEXT("Recovery isn't pushed back"), Model.GetNextTransitionTime(), 10.f);
+	Model.SetSprintHeld(false, 9.f);
+
+	Model.AdvanceTo(10.f);
+	TestTrue(TEXT("Normal at 10s"), Model.Status == EStaminaStatus::ESS_Normal);
+	TestEqual(TEXT("At the minimum"), Model.GetStamina(10.f), 50.f);
+	TestEqual(TEXT("Full at 14s"), Model.GetNextTransitionTime(), 14.f);
+
+	Model.AdvanceTo(20.f);
+	TestEqual(TEXT("Stops at the max"), Model.GetStamina(20.f), 150.f);
+	TestEqual(TEXT("Stopped"), Model.GetRate(), 0.f);
+	TestEqual(TEXT("Nothing scheduled once full"), Model.GetNextTransitionTime(), -1.f);
+
+	return true;
+}
+
+// The component only gets a callback for the next threshold, so a late one has to catch up through everything it missed
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStaminaModelSkippedThresholdsTest, "MyProject.Stamina.SkippedThresholds",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FStaminaModelSkippedThresholdsTest::RunTest(const FString& Parameters)
+{
+	FStaminaModel Model = MakeDefaultStaminaModel(150.f);
+	Model.SetSprintHeld(true, 0.f);
+
+	Model.AdvanceTo(7.f);
+	TestTrue(TEXT("Straight through the minimum to exhausted"), Model.Status == EStaminaStatus::ESS_Exhausted);
+	TestEqual(TEXT("Empty"), Model.GetStamina(7.f), 0.f);
+
+	// Let go short of the minimum, then go straight past it and the max in one step
+	Model.SetSprintHeld(false, 7.f);
+	Model.AdvanceTo(30.f);
+	TestTrue(TEXT("Back to normal"), Model.Status == EStaminaStatus::ESS_Normal);
+	TestEqual(TEXT("Full"), Model.GetStamina(30.f), 150.f);
+
+	return true;
+}
+
+// Letting go below the minimum, without running out, just turns around and heads back up
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStaminaModelBelowMinimumRecoveryTest, "MyProject.Stamina.BelowMinimumRecovery",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FStaminaModelBelowMinimumRecoveryTest::RunTest(const FString& Parameters)
+{
+	FStaminaModel Model = MakeDefaultStaminaModel(150.f);
+	Model.SetSprintHeld(true, 0.f);
+	Model.SetSprintHeld(false, 5.f);
+
+	TestTrue(TEXT("Below minimum after 5s"), Model.Status == EStaminaStatus::ESS_BelowMinimum);
+	TestEqual(TEXT("25 left"), Model.GetStamina(5.f), 25.f);
+	TestEqual(TEXT("Recovering"), Model.GetRate(), 25.f);
+	TestEqual(TEXT("Back to the minimum 1s later"), Model.GetNextTransitionTime(), 6.f);
+
+	Model.AdvanceTo(6.f);
+	TestTrue(TEXT("Normal at 6s"), Model.Status == EStaminaStatus::ESS_Normal);
+	TestEqual(TEXT("Full at 10s"), Model.GetNextTransitionTime(), 10.f);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
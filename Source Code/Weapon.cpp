@@ -5,12 +5,12 @@
 #include "Components/SkeletalMeshComponent.h"
 #include "Main.h"
 #include "Engine/SkeletalMeshSocket.h"
+#include "CombatImpactSubsystem.h"
 #include "Sound/SoundCue.h"
 #include "Kismet/GameplayStatics.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Components/BoxComponent.h"
 #include "Enemy.h"
-#include "Engine/SkeletalMeshSocket.h"
 
 AWeapon::AWeapon()
 {
@@ -25,12 +25,16 @@ AWeapon::AWeapon()
     WeaponState = EWeaponState::EWS_Pickup;
 
     Damage = 25.f; // Initial damage inflicted by our weapon
+
+    WeaponSocket = nullptr;
 }
 
 void AWeapon::BeginPlay()
 {
     Super::BeginPlay();
 
+    WeaponSocket = SkeletalMesh->GetSocketByName("WeaponSocket");
+
     CombatCollision->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::CombatOnOverlapBegin);
     CombatCollision->OnComponentEndOverlap.AddDynamic(this, &AWeapon::CombatOnOverlapEnd);   
     // AddDynamic is a helper macro to bind a UObject instance and a member UFUNCTION to a dynamic mult-cast delegate
@@ -105,8 +109,8 @@ void AWeapon::Equip(AMain* Char)
             // Calling Equip, will attach whatever is calling it to the RightHandSocket to the skeleton
             // Also helped to program some physics and collision settings that we need upon equipping
             
-            // As soon as we attach to the actor, set bRotate to false
-            bRotate = false;
+            // As soon as we attach to the actor, stop rotating
+            SetRotating(false);
 
             Char->SetEquippedWeapon(this); // Sets the equipped weapon to this particular weapon instance
             Char->SetActiveOverlappingItem(nullptr);
@@ -129,23 +133,14 @@ void AWeapon::CombatOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AAc
         AEnemy* Enemy = Cast<AEnemy>(OtherActor);
         if (Enemy)
         {
-            // Attempt to play the HitParticles
-            // So we need to check to make sure the HitParticles are working
-            if (Enemy->HitParticles)
-            {
-                // reference to the socket we created on the weapon
-                const USkeletalMeshSocket* WeaponSocket = SkeletalMesh->GetSocketByName("WeaponSocket");
-                if (WeaponSocket)
-                {
-                    // Spawn the emitter at the location of our socket
-                    FVector SocketLocation = WeaponSocket->GetSocketLocation(SkeletalMesh);
-                    UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Enemy->HitParticles, SocketLocation, FRotator(0.f), false);
-                    // This will spawn the particle system at our swords blade instead of the entire sword
-                }
-            }
-            if (Enemy->HitSound)
+            // Hit particles and sound go through the impact subsystem, which reuses components and drops duplicate hits in the same frame
+            UCombatImpactSubsystem* Impacts = GetWorld()->GetSubsystem<UCombatImpactSubsystem>();
+            if (Impacts)
             {
-                UGameplayStatics::PlaySound2D(this, Enemy->HitSound); // As long as the enemy has a hit sound on the blueprint, this will work
+                // Particles spawn at our swords blade instead of the entire sword, so no socket means no particles
+                UParticleSystem* Particles = WeaponSocket ? Enemy->HitParticles : nullptr;
+                FVector SocketLocation = WeaponSocket ? WeaponSocket->GetSocketLocation(SkeletalMesh) : GetActorLocation();
+                Impacts->PlayImpact(Particles, Enemy->HitSound, SocketLocation);
             }
             if (DamageTypeClass)
             {
@@ -51,6 +51,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Sound")
 	USoundCue* SwingSound;
 
+	/** WeaponSocket on our mesh, looked up once in BeginPlay instead of on every hit */
+	UPROPERTY(Transient)
+	const class USkeletalMeshSocket* WeaponSocket;
+
 protected: // Need to do this because BeginPlay() is protected in the base class
 
 	virtual void BeginPlay() override;
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponRegistrySubsystem.h"
+#include "Weapon.h"
+#include "ItemStorage.h"
+#include "Engine/AssetManager.h"
+
+void UWeaponRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// The catalog is only names and soft references, loading it up front is cheap
+	if (!Catalog.IsNull())
+	{
+		RegisterCatalog(Catalog.LoadSynchronous());
+	}
+}
+
+void UWeaponRegistrySubsystem::RegisterWeapon(FName WeaponName, const TSoftClassPtr<AWeapon>& WeaponClass)
+{
+	if (WeaponName.IsNone() || WeaponClass.IsNull()) return;
+
+	Weapons.Add(WeaponName, WeaponClass);
+}
+
+void UWeaponRegistrySubsystem::RegisterCatalog(const UWeaponCatalog* InCatalog)
+{
+	if (InCatalog == nullptr) return;
+
+	for (const TPair<FName, TSoftClassPtr<AWeapon>>& Entry : InCatalog->Weapons)
+	{
+		RegisterWeapon(Entry.Key, Entry.Value);
+	}
+}
+
+void UWeaponRegistrySubsystem::RegisterItemStorage(TSubclassOf<AItemStorage> Storage)
+{
+	const AItemStorage* StorageDefaults = Storage ? Storage->GetDefaultObject<AItemStorage>() : nullptr;
+	if (StorageDefaults == nullptr) return;
+
+	for (const TPair<FString, TSubclassOf<AWeapon>>& Entry : StorageDefaults->WeaponMap)
+	{
+		const FName WeaponName(*Entry.Key);
+		// A catalog entry wins over the old storage actor
+		if (!Weapons.Contains(WeaponName))
+		{
+			RegisterWeapon(WeaponName, TSoftClassPtr<AWeapon>(Entry.Value.Get()));
+		}
+	}
+}
+
+bool UWeaponRegistrySubsystem::HasWeapon(FName WeaponName) const
+{
+	return Weapons.Contains(WeaponName);
+}
+
+TSoftClassPtr<AWeapon> UWeaponRegistrySubsystem::FindWeapon(FName WeaponName) const
+{
+	const TSoftClassPtr<AWeapon>* WeaponClass = Weapons.Find(WeaponName);
+	return WeaponClass ? *WeaponClass : TSoftClassPtr<AWeapon>();
+}
+
+TSubclassOf<AWeapon> UWeaponRegistrySubsystem::GetLoadedWeaponClass(FName WeaponName) const
+{
+	const TSoftClassPtr<AWeapon>* WeaponClass = Weapons.Find(WeaponName);
+	return WeaponClass ? WeaponClass->Get() : nullptr;
+}
+
+void UWeaponRegistrySubsystem::RequestWeaponClass(FName WeaponName, FOnWeaponClassLoaded OnLoaded)
+{
+	const TSoftClassPtr<AWeapon>* WeaponClass = Weapons.Find(WeaponName);
+	if (WeaponClass == nullptr || WeaponClass->Get())
+	{
+		// Nothing to load, either we don't know it or it's already in memory
+		OnLoaded.ExecuteIfBound(WeaponName, WeaponClass ? WeaponClass->Get() : nullptr);
+		return;
+	}
+
+	// The streamable manager merges requests for the same class, so asking twice while it's loading is fine
+	LoadHandles.Add(WeaponName, UAssetManager::GetStreamableManager().RequestAsyncLoad(WeaponClass->ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &UWeaponRegistrySubsystem::OnWeaponClassLoaded, WeaponName, OnLoaded)));
+}
+
+void UWeaponRegistrySubsystem::OnWeaponClassLoaded(FName WeaponName, FOnWeaponClassLoaded OnLoaded)
+{
+	OnLoaded.ExecuteIfBound(WeaponName, GetLoadedWeaponClass(WeaponName));
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "WeaponRegistrySubsystem.generated.h"
+
+class AWeapon;
+
+/** Fired once a weapon class has been loaded. The class is null if the name isn't in the registry or the load failed */
+DECLARE_DELEGATE_TwoParams(FOnWeaponClassLoaded, FName /*WeaponName*/, TSubclassOf<AWeapon> /*WeaponClass*/);
+
+/**
+ * Every weapon a save can refer to, by the name stored in AWeapon::Name
+ * Soft so the catalog can be loaded without loading a single weapon
+ */
+UCLASS(BlueprintType)
+class MYPROJECT_API UWeaponCatalog : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "SaveData")
+	TMap<FName, TSoftClassPtr<AWeapon>> Weapons;
+};
+
+/**
+ * Looks weapon classes up by name for the save system, replacing the AItemStorage actor we used to spawn on every load
+ *
+ * Only holds soft references, and loads a weapon class asynchronously the first time someone asks for it.
+ * Whatever has been loaded stays loaded for the rest of the session, so only the weapons saves actually use cost anything
+ */
+UCLASS(Config = Game)
+class MYPROJECT_API UWeaponRegistrySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Set in DefaultGame.ini under [/Script/MyProject.WeaponRegistrySubsystem] */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UWeaponCatalog> Catalog;
+
+	// USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Adds or replaces one entry */
+	void RegisterWeapon(FName WeaponName, const TSoftClassPtr<AWeapon>& WeaponClass);
+
+	/** Adds everything from a catalog */
+	void RegisterCatalog(const UWeaponCatalog* InCatalog);
+
+	/**
+	 * Adds the WeaponMap of an old AItemStorage Blueprint, read off its default object so nothing gets spawned.
+	 * Those classes are hard references, so they're already in memory; this is only so content that hasn't moved to a catalog keeps working
+	 */
+	void RegisterItemStorage(TSubclassOf<class AItemStorage> Storage);
+
+	bool HasWeapon(FName WeaponName) const;
+
+	/** The soft reference for a name, null if we don't know it */
+	TSoftClassPtr<AWeapon> FindWeapon(FName WeaponName) const;
+
+	/** The class if it's already in memory, without loading anything */
+	TSubclassOf<AWeapon> GetLoadedWeaponClass(FName WeaponName) const;
+
+	/** Loads the class in the background if needed and calls OnLoaded with it. Calls straight back if it's already loaded or unknown */
+	void RequestWeaponClass(FName WeaponName, FOnWeaponClassLoaded OnLoaded);
+
+private:
+	void OnWeaponClassLoaded(FName WeaponName, FOnWeaponClassLoaded OnLoaded);
+
+	TMap<FName, TSoftClassPtr<AWeapon>> Weapons;
+
+	/** Keeps every weapon we've loaded in memory */
+	TMap<FName, TSharedPtr<FStreamableHandle>> LoadHandles;
+};
@@ -0,0 +1,467 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WorldStateSubsystem.h"
+#include "MyProject.h"
+#include "Engine/Level.h"
+#include "GameFramework/Actor.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "HAL/FileManager.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+DECLARE_CYCLE_STAT(TEXT("World State Apply"), STAT_WorldStateApply, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("World State Actors Removed"), STAT_WorldStateActorsRemoved, STATGROUP_MyProject);
+DECLARE_DWORD_COUNTER_STAT(TEXT("World State Record Bytes"), STAT_WorldStateRecordBytes, STATGROUP_MyProject);
+
+// World file: magic and version, then records of [size][crc][payload] one after another
+// 1: actor names with a bit each. Never shipped, and dropped on load
+// 2: per level name checksum and bitset, actors identified by their index in the level's sorted names
+static const uint32 WorldStateMagic = 0x5357504D; // "MPWS"
+static const uint32 WorldStateVersion = 2;
+static const int32 WorldStateFileHeaderSize = 8;
+static const int32 WorldStateRecordHeaderSize = 8;
+
+UWorldStateSubsystem::UWorldStateSubsystem()
+{
+	CompactAfterRecords = 32;
+
+	bNeedsFullWrite = true; // Nothing on disk yet as far as we know
+	RecordsSinceCompaction = 0;
+}
+
+void UWorldStateSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Runs once the level's actors exist but before any of them have had BeginPlay, so consumed ones never start up at all
+	WorldInitializedActorsHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UWorldStateSubsystem::OnWorldInitializedActors);
+
+	// Streamed in levels have no hook that early, they get cleaned up as soon as they're added
+	LevelAddedToWorldHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UWorldStateSubsystem::OnLevelAddedToWorld);
+}
+
+void UWorldStateSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(WorldInitializedActorsHandle);
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedToWorldHandle);
+
+	Super::Deinitialize();
+}
+
+FName UWorldStateSubsystem::GetLevelKey(const ULevel* Level)
+{
+	const UPackage* Package = Level ? Level->GetOutermost() : nullptr;
+	if (Package == nullptr) return NAME_None;
+
+	FString LevelName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(Package->GetName()));
+
+	// Levels a transition volume streams in as instances get a numbered suffix that changes from run to run
+	const int32 InstanceSuffix = LevelName.Find(TEXT("_LevelInstance_"), ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+	if (InstanceSuffix != INDEX_NONE)
+	{
+		LevelName.LeftInline(InstanceSuffix);
+	}
+
+	return FName(*LevelName);
+}
+
+FLevelWorldState* UWorldStateSubsystem::IndexLevel(ULevel* Level)
+{
+	const FName LevelKey = GetLevelKey(Level);
+	if (LevelKey.IsNone()) return nullptr;
+
+	FLevelWorldState& State = Levels.FindOrAdd(LevelKey);
+	if (State.bIndexed) return &State;
+
+	// This has to see the level as it was loaded, before anything in it was consumed, or the indices shift.
+	// The level hooks below get here before any actor has begun play, and it only ever happens once a session per level
+	State.ActorIds.Reset();
+	State.IdIndices.Reset();
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor && Actor->IsNetStartupActor())
+		{
+			State.ActorIds.Add(Actor->GetFName());
+		}
+	}
+	State.ActorIds.Sort(FNameLexicalLess());
+
+	uint32 Signature = 0;
+	for (int32 i = 0; i < State.ActorIds.Num(); i++)
+	{
+		State.IdIndices.Add(State.ActorIds[i], i);
+		Signature = FCrc::StrCrc32(*State.ActorIds[i].ToString(), Signature);
+	}
+
+	// Bits from the world file are only any good if they were saved against the same actors
+	const bool bHasLoadedBits = State.Consumed.Num() > 0;
+	if (bHasLoadedBits && (State.Signature != Signature || State.Consumed.Num() != State.ActorIds.Num()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("World state for %s was saved against a different version of the level, forgetting what was consumed there"), *LevelKey.ToString());
+		State.Consumed.Reset();
+		State.DirtyBits.Reset();
+		bNeedsFullWrite = true;
+	}
+	if (State.Consumed.Num() != State.ActorIds.Num())
+	{
+		State.Consumed.Init(false, State.ActorIds.Num());
+	}
+
+	State.Signature = Signature;
+	State.bIndexed = true;
+	return &State;
+}
+
+void UWorldStateSubsystem::RecordConsumed(const AActor* Actor)
+{
+	// Only things placed in the level have a name we'll see again next time it loads
+	if (Actor == nullptr || !Actor->IsNetStartupActor()) return;
+
+	FLevelWorldState* Level = IndexLevel(Actor->GetLevel());
+	const int32* Index = Level ? Level->IdIndices.Find(Actor->GetFName()) : nullptr;
+	if (Index && !Level->Consumed[*Index])
+	{
+		Level->Consumed[*Index] = true;
+		Level->DirtyBits.Add(*Index);
+	}
+}
+
+bool UWorldStateSubsystem::IsConsumed(const AActor* Actor) const
+{
+	if (Actor == nullptr) return false;
+
+	// Any level an actor is in has been through IndexLevel already
+	const FLevelWorldState* Level = Levels.Find(GetLevelKey(Actor->GetLevel()));
+	const int32* Index = (Level && Level->bIndexed) ? Level->IdIndices.Find(Actor->GetFName()) : nullptr;
+	return Index && Level->Consumed[*Index];
+}
+
+void UWorldStateSubsystem::OnWorldInitializedActors(const UWorld::FActorsInitializedParams& Params)
+{
+	if (Params.World && Params.World->IsGameWorld())
+	{
+		ApplyToWorld(Params.World);
+	}
+}
+
+void UWorldStateSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World && World->IsGameWorld())
+	{
+		ApplyToLevel(Level);
+	}
+}
+
+void UWorldStateSubsystem::ApplyToWorld(UWorld* World)
+{
+	if (World == nullptr) return;
+
+	for (ULevel* Level : World->GetLevels())
+	{
+		ApplyToLevel(Level);
+	}
+}
+
+void UWorldStateSubsystem::ApplyToLevel(ULevel* Level)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WorldStateApply);
+
+	const FLevelWorldState* State = Level ? IndexLevel(Level) : nullptr;
+	if (State == nullptr || State->Consumed.Find(true) == INDEX_NONE) return;
+
+	// Copy, destroying actors changes the level's list
+	TArray<AActor*> Actors = Level->Actors;
+	int32 NumRemoved = 0;
+	for (AActor* Actor : Actors)
+	{
+		if (Actor == nullptr || Actor->IsPendingKill()) continue;
+
+		const int32* Index = State->IdIndices.Find(Actor->GetFName());
+		if (Index && State->Consumed[*Index])
+		{
+			Actor->Destroy();
+			NumRemoved++;
+		}
+	}
+	SET_DWORD_STAT(STAT_WorldStateActorsRemoved, NumRemoved);
+}
+
+void UWorldStateSubsystem::Reset()
+{
+	// Levels we've indexed keep their indices, the actors in them that are already gone couldn't be indexed again
+	for (auto It = Levels.CreateIterator(); It; ++It)
+	{
+		FLevelWorldState& Level = It.Value();
+		if (Level.bIndexed)
+		{
+			Level.Consumed.Init(false, Level.ActorIds.Num());
+			Level.DirtyBits.Reset();
+		}
+		else
+		{
+			It.RemoveCurrent();
+		}
+	}
+	bNeedsFullWrite = true;
+	RecordsSinceCompaction = 0;
+}
+
+void UWorldStateSubsystem::WriteLevelRecord(FArchive& Ar, FName LevelKey, const FLevelWorldState& Level, const TArray<int32>* DirtyBits)
+{
+	FString LevelName = LevelKey.ToString();
+	Ar << LevelName;
+
+	uint32 Signature = Level.Signature;
+	uint32 NumIds = Level.Consumed.Num();
+	uint8 bFull = DirtyBits == nullptr;
+	Ar << Signature;
+	Ar.SerializeIntPacked(NumIds);
+	Ar << bFull;
+
+	if (bFull)
+	{
+		// The whole bitset, 8 actors to a byte
+		for (uint32 ByteStart = 0; ByteStart < NumIds; ByteStart += 8)
+		{
+			uint8 Byte = 0;
+			for (uint32 Bit = ByteStart; Bit < FMath::Min(ByteStart + 8, NumIds); Bit++)
+			{
+				Byte |= Level.Consumed[Bit] ? (1 << (Bit - ByteStart)) : 0;
+			}
+			Ar << Byte;
+		}
+		return;
+	}
+
+	// Just the bits set since the last save, sorted and stored as gaps from the previous one, which keeps them to a byte each most of the time
+	TArray<int32> Bits = *DirtyBits;
+	Bits.Sort();
+	uint32 NumBits = Bits.Num();
+	Ar.SerializeIntPacked(NumBits);
+	int32 Previous = 0;
+	for (int32 Bit : Bits)
+	{
+		uint32 Gap = Bit - Previous;
+		Ar.SerializeIntPacked(Gap);
+		Previous = Bit;
+	}
+}
+
+bool UWorldStateSubsystem::TakeRecord(TArray<uint8>& OutRecord, bool& bOutFull)
+{
+	bOutFull = bNeedsFullWrite || RecordsSinceCompaction >= CompactAfterRecords;
+
+	// Levels with nothing consumed don't need anything on disk at all
+	TArray<FName> LevelKeys;
+	for (const TPair<FName, FLevelWorldState>& Pair : Levels)
+	{
+		if (bOutFull ? Pair.Value.Consumed.Find(true) != INDEX_NONE : Pair.Value.DirtyBits.Num() > 0)
+		{
+			LevelKeys.Add(Pair.Key);
+		}
+	}
+	if (!bOutFull && LevelKeys.Num() == 0) return false; // Nothing new since the last save
+
+	TArray<uint8> Payload;
+	FMemoryWriter Writer(Payload);
+	uint32 NumLevels = LevelKeys.Num();
+	Writer.SerializeIntPacked(NumLevels);
+
+	for (FName LevelKey : LevelKeys)
+	{
+		FLevelWorldState& Level = Levels[LevelKey];
+		WriteLevelRecord(Writer, LevelKey, Level, bOutFull ? nullptr : &Level.DirtyBits);
+		Level.DirtyBits.Reset();
+	}
+
+	uint32 PayloadSize = Payload.Num();
+	uint32 Checksum = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+	OutRecord.Reset(WorldStateRecordHeaderSize + Payload.Num());
+	FMemoryWriter RecordWriter(OutRecord);
+	RecordWriter << PayloadSize << Checksum;
+	OutRecord.Append(Payload);
+
+	SET_DWORD_STAT(STAT_WorldStateRecordBytes, OutRecord.Num());
+
+	if (bOutFull)
+	{
+		bNeedsFullWrite = false;
+		RecordsSinceCompaction = 1;
+	}
+	else
+	{
+		RecordsSinceCompaction++;
+	}
+	return true;
+}
+
+bool UWorldStateSubsystem::WriteRecord(const FString& Path, const TArray<uint8>& Record, bool bFull)
+{
+	if (!bFull)
+	{
+		// A delta on its own is useless, the caller has to fall back to a full write
+		if (!IFileManager::Get().FileExists(*Path)) return false;
+
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path, FILEWRITE_Append | FILEWRITE_Silent));
+		if (Writer == nullptr) return false;
+
+		// A crash part way through leaves a short last record, which the loader spots by its size and checksum and drops
+		Writer->Serialize(const_cast<uint8*>(Record.GetData()), Record.Num());
+		return Writer->Close();
+	}
+
+	TArray<uint8> File;
+	FMemoryWriter FileWriter(File);
+	uint32 Magic = WorldStateMagic;
+	uint32 Version = WorldStateVersion;
+	FileWriter << Magic << Version;
+	File.Append(Record);
+
+	// Same as the player save, write it alongside and move it over the old one. See ReadWorldFile for a crash part way through the move
+	const FString TempPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(File, *TempPath))
+	{
+		return false;
+	}
+	return IFileManager::Get().Move(*Path, *TempPath, true, true);
+}
+
+bool UWorldStateSubsystem::ReadWorldFile(const FString& Path, TArray<uint8>& OutFile)
+{
+	if (FFileHelper::LoadFileToArray(OutFile, *Path, FILEREAD_Silent)) return true;
+
+	// Only a full write goes through the temp file, so what's in it is a whole file on its own
+	const FString TempPath = Path + TEXT(".tmp");
+	if (IFileManager::Get().FileExists(*Path) || !FFileHelper::LoadFileToArray(OutFile, *TempPath, FILEREAD_Silent)) return false;
+
+	IFileManager::Get().Move(*Path, *TempPath, true, true);
+	return true;
+}
+
+void UWorldStateSubsystem::LoadFromFile(const TArray<uint8>& File)
+{
+	Reset();
+
+	if (File.Num() < WorldStateFileHeaderSize) return;
+
+	// Reset asks for a full write in case there's no usable file. Anything the records below don't cover asks again
+	bNeedsFullWrite = false;
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	FMemory::Memcpy(&Magic, File.GetData(), sizeof(Magic));
+	FMemory::Memcpy(&Version, File.GetData() + sizeof(Magic), sizeof(Version));
+	if (Magic != WorldStateMagic || Version != WorldStateVersion)
+	{
+		bNeedsFullWrite = true;
+		return;
+	}
+
+	bool bDamaged = false;
+	int32 Offset = WorldStateFileHeaderSize;
+	while (Offset + WorldStateRecordHeaderSize <= File.Num())
+	{
+		uint32 PayloadSize = 0;
+		uint32 Checksum = 0;
+		FMemory::Memcpy(&PayloadSize, File.GetData() + Offset, sizeof(PayloadSize));
+		FMemory::Memcpy(&Checksum, File.GetData() + Offset + sizeof(PayloadSize), sizeof(Checksum));
+
+		const uint8* Payload = File.GetData() + Offset + WorldStateRecordHeaderSize;
+		if ((int64)Offset + WorldStateRecordHeaderSize + PayloadSize > File.Num()
+			|| FCrc::MemCrc32(Payload, PayloadSize) != Checksum
+			|| !ReadRecord(Payload, PayloadSize))
+		{
+			bDamaged = true;
+			break;
+		}
+
+		Offset += WorldStateRecordHeaderSize + PayloadSize;
+		RecordsSinceCompaction++;
+	}
+	bDamaged |= Offset != File.Num();
+
+	// Everything we've got now is on disk already
+	for (TPair<FName, FLevelWorldState>& Pair : Levels)
+	{
+		Pair.Value.DirtyBits.Reset();
+	}
+
+	// Keep everything up to the damage, and rewrite the file cleanly on the next save
+	bNeedsFullWrite |= bDamaged;
+}
+
+bool UWorldStateSubsystem::ReadRecord(const uint8* Data, int32 Size)
+{
+	TArray<uint8> Payload(Data, Size);
+	FMemoryReader Reader(Payload);
+
+	uint32 NumLevels = 0;
+	Reader.SerializeIntPacked(NumLevels);
+	for (uint32 LevelIndex = 0; LevelIndex < NumLevels && !Reader.IsError(); LevelIndex++)
+	{
+		FString LevelName;
+		Reader << LevelName;
+		const FName LevelKey(*LevelName);
+		FLevelWorldState& Level = Levels.FindOrAdd(LevelKey);
+
+		uint32 Signature = 0;
+		uint32 NumIds = 0;
+		uint8 bFull = 0;
+		Reader << Signature;
+		Reader.SerializeIntPacked(NumIds);
+		Reader << bFull;
+		if (Reader.IsError() || NumIds > (uint32)Size * 8) return false;
+
+		// The first record we see for a level we haven't loaded yet sets the indices it's checked against when it does load
+		if (!Level.bIndexed && Level.Consumed.Num() == 0)
+		{
+			Level.Signature = Signature;
+			Level.Consumed.Init(false, NumIds);
+		}
+
+		// A level that's already loaded and has changed since this was written. Read past it and save over it later
+		const bool bMatches = Level.Signature == Signature && (uint32)Level.Consumed.Num() == NumIds;
+		if (!bMatches && !Level.bIndexed) return false;
+		if (!bMatches)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("World state for %s was saved against a different version of the level, ignoring it"), *LevelName);
+			bNeedsFullWrite = true;
+		}
+
+		if (bFull)
+		{
+			for (uint32 ByteStart = 0; ByteStart < NumIds && !Reader.IsError(); ByteStart += 8)
+			{
+				uint8 Byte = 0;
+				Reader << Byte;
+				for (uint32 Bit = ByteStart; bMatches && Bit < FMath::Min(ByteStart + 8, NumIds); Bit++)
+				{
+					Level.Consumed[Bit] = (Byte & (1 << (Bit - ByteStart))) != 0;
+				}
+			}
+			continue;
+		}
+
+		uint32 NumBits = 0;
+		Reader.SerializeIntPacked(NumBits);
+		if (NumBits > NumIds) return false;
+
+		uint32 Bit = 0;
+		for (uint32 i = 0; i < NumBits && !Reader.IsError(); i++)
+		{
+			uint32 Gap = 0;
+			Reader.SerializeIntPacked(Gap);
+			Bit += Gap;
+			if (Bit >= NumIds) return false;
+			if (bMatches)
+			{
+				Level.Consumed[Bit] = true;
+			}
+		}
+	}
+
+	return !Reader.IsError();
+}
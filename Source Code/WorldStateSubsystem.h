@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "WorldStateSubsystem.generated.h"
+
+/** What we remember about one level. Bit i of Consumed belongs to ActorIds[i] */
+struct FLevelWorldState
+{
+	/**
+	 * Names of every level placed actor in the level, sorted, so an actor's index is the same every time the level loads
+	 * Only filled in once the level has been loaded this session, see bIndexed. Nothing but the bits is ever saved
+	 */
+	TArray<FName> ActorIds;
+	TMap<FName, int32> IdIndices;
+
+	/** Checksum of the sorted names. Saved with the bits, so bits saved against an older version of the level aren't applied to the wrong actors */
+	uint32 Signature = 0;
+
+	/** One bit per actor. Loaded from a world file before the level is indexed, it's checked against Signature once it is */
+	TBitArray<> Consumed;
+
+	bool bIndexed = false;
+
+	/** Bits set since the last save */
+	TArray<int32> DirtyBits;
+};
+
+/**
+ * Remembers which level placed enemies were killed, pickups collected and explosives set off, so they stay gone after a load
+ *
+ * Every level placed actor gets a stable index: its position in the level's actor names, sorted, worked out the first time the
+ * level loads. Things spawned at runtime aren't tracked. Each level is then just a bitset with one bit per actor and a checksum
+ * of the names, so a level that's been edited since the save was made is spotted and its bits dropped instead of hitting the wrong actors.
+ * Nothing is ever un-consumed, so a save only needs the bits set since the last one, and those get appended to the slot's world
+ * file as one small record. The file is rewritten in full every CompactAfterRecords saves, or if something went wrong.
+ * When a level loads, consumed actors are destroyed after the level's actors are initialized but before any of them begin play.
+ */
+UCLASS(Config = Game)
+class MYPROJECT_API UWorldStateSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWorldStateSubsystem();
+
+	/** After this many appended records the next save rewrites the world file from scratch */
+	UPROPERTY(Config)
+	int32 CompactAfterRecords;
+
+	// USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Call when a level placed actor is killed, collected or destroyed for good. Ignores anything spawned at runtime */
+	void RecordConsumed(const AActor* Actor);
+
+	bool IsConsumed(const AActor* Actor) const;
+
+	/** Destroys every actor in World that we have down as consumed */
+	void ApplyToWorld(UWorld* World);
+
+	/** Same for one level, used for streamed in levels */
+	void ApplyToLevel(ULevel* Level);
+
+	/** Forget everything, e.g. when loading a slot that has no world file */
+	void Reset();
+
+	/** Next save writes the whole state instead of a delta */
+	FORCEINLINE void MarkAllDirty() { bNeedsFullWrite = true; }
+
+	/**
+	 * Game thread half of a save. Encodes what changed since the last call into Record, or everything if a full write is due.
+	 * Returns false if there's nothing to write. bOutFull says whether Record replaces the file or gets appended to it
+	 */
+	bool TakeRecord(TArray<uint8>& OutRecord, bool& bOutFull);
+
+	/** Replaces our state with the contents of a world file. A damaged tail is dropped and the next save rewrites the file */
+	void LoadFromFile(const TArray<uint8>& File);
+
+	/** Worker thread half of a save. Appends the record or replaces the file with it */
+	static bool WriteRecord(const FString& Path, const TArray<uint8>& Record, bool bFull);
+
+	/**
+	 * Loads a world file. If it's missing but a full write's temp file was left behind (a crash between Move deleting the old file
+	 * and renaming), that's moved into place and used instead. Its records are checksummed, so a half written one is dropped on load
+	 */
+	static bool ReadWorldFile(const FString& Path, TArray<uint8>& OutFile);
+
+private:
+	void OnWorldInitializedActors(const UWorld::FActorsInitializedParams& Params);
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+
+	/** Package name of the level without any PIE prefix or level instance suffix, so the same level always gets the same key */
+	static FName GetLevelKey(const ULevel* Level);
+
+	/** Works out the level's actor indices the first time it's seen this session, and checks any bits loaded for it still fit */
+	FLevelWorldState* IndexLevel(ULevel* Level);
+
+	/** Encodes one level's part of a record. Its whole bitset if DirtyBits is null, otherwise just those bits */
+	static void WriteLevelRecord(FArchive& Ar, FName LevelKey, const FLevelWorldState& Level, const TArray<int32>* DirtyBits);
+
+	/** Applies one record read back from a world file */
+	bool ReadRecord(const uint8* Data, int32 Size);
+
+	TMap<FName, FLevelWorldState> Levels;
+
+	bool bNeedsFullWrite;
+	int32 RecordsSinceCompaction;
+
+	FDelegateHandle WorldInitializedActorsHandle;
+	FDelegateHandle LevelAddedToWorldHandle;
+};